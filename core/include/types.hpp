@@ -4,6 +4,7 @@
 #include <vector>
 #include <unordered_map>
 #include <optional>
+#include <memory>
 #include <cstdint>
 
 namespace cachesim {
@@ -13,11 +14,41 @@ struct ArcMeta {
     int p;
 };
 
+struct Stats {
+    uint64_t hits = 0, misses = 0, evictions = 0;
+    uint64_t expirations = 0;   // entries dropped because their TTL ran out (not in evictions)
+    uint64_t ghostHits = 0;     // GETs that found the key in a ghost list (ARC); counted as misses
+    uint64_t hitPathWrites = 0; // replacement-metadata writes made by GET hits
+    uint64_t bytesHit = 0, bytesMissed = 0, bytesEvicted = 0; // only when bytes are tracked
+    
+    double hitRatio() const { 
+        auto total = hits + misses; 
+        return total ? double(hits) / double(total) : 0.0; 
+    }
+    
+    double byteHitRatio() const {
+        auto total = bytesHit + bytesMissed;
+        return total ? double(bytesHit) / double(total) : 0.0;
+    }
+    
+    void merge(const Stats& other) {
+        hits += other.hits;
+        misses += other.misses;
+        evictions += other.evictions;
+        expirations += other.expirations;
+        ghostHits += other.ghostHits;
+        hitPathWrites += other.hitPathWrites;
+        bytesHit += other.bytesHit;
+        bytesMissed += other.bytesMissed;
+        bytesEvicted += other.bytesEvicted;
+    }
+};
+
 struct Step {
     int index;
-    std::string op;           // "GET" | "PUT"
+    std::string op;           // "GET" | "PUT" | "DEL"
     std::string key;
-    std::string value;        // empty for GET
+    std::string value;        // empty for GET and DEL
     bool hit;
     std::optional<std::string> evicted; // key evicted
     // Cache state after this step
@@ -25,22 +56,26 @@ struct Step {
     // optional metadata for UI (freqs, ARC sets)
     std::unordered_map<std::string, int> freq; 
     std::optional<ArcMeta> arc;
-};
-
-struct Stats {
-    uint64_t hits = 0, misses = 0, evictions = 0;
-    
-    double hitRatio() const { 
-        auto total = hits + misses; 
-        return total ? double(hits) / double(total) : 0.0; 
-    }
+    Stats totals; // cumulative stats through this step
 };
 
 struct TraceOp {
-    enum class Kind { GET, PUT };
+    enum class Kind { GET, PUT, DEL }; // DEL drops the key without counting an eviction
     Kind kind;
     std::string key;
-    std::string value; // empty if GET
+    std::string value; // empty if GET or DEL
+    uint64_t size = 0; // object size in bytes (size=N in traces); 0 = value length
+    bool fill = false; // GET only: a miss inserts the key (demand fill)
+    uint64_t timestamp = 0; // trace time in seconds (ts=N, or from imported traces); 0 = unknown
+    uint64_t ttl = 0;       // PUT or demand fill: seconds until the entry expires; 0 = never
+    
+    uint64_t objectSize() const { return size ? size : value.size(); }
+};
+
+// Scalar policy state sampled for time series; -1 = not applicable
+struct PolicyGauges {
+    int arcP = -1;
+    int lfuMinFrequency = -1;
 };
 
 class IPolicy {
@@ -48,23 +83,82 @@ public:
     virtual ~IPolicy() = default;
     virtual bool get(const std::string& key, std::string& outVal) = 0;
     virtual std::optional<std::string> put(const std::string& key, const std::string& val) = 0;
+    
+    // Size-aware insert; only size-based policies (GDSF) care about `size`
+    virtual std::optional<std::string> putSized(const std::string& key, const std::string& val, uint64_t size) {
+        (void)size;
+        return put(key, val);
+    }
+    
+    // Evicts the policy's next victim without inserting (used to enforce byte budgets)
+    virtual std::optional<std::string> evict() = 0;
+    
+    // Drops `key` if resident without counting as an eviction (used to keep
+    // cache hierarchies inclusive/exclusive); returns whether it was resident
+    virtual bool erase(const std::string& key) = 0;
     virtual std::vector<std::pair<std::string, std::string>> snapshot() const = 0; // display order
     virtual void metaForUI(Step& s) const { (void)s; } // optional (LFU freq, ARC sets)
     
     // For ARC policy to distinguish between cache hits and ghost hits
     virtual bool isCacheHit(const std::string& key) const { (void)key; return false; }
+
+    // Cumulative count of metadata writes (list relinks, counter/flag updates) on GET hits
+    virtual uint64_t hitPathWrites() const { return 0; }
+    
+    virtual PolicyGauges gauges() const { return PolicyGauges{}; }
+    
+    // Access frequency the policy holds for `key` (LFU's count, 0 if not
+    // resident; W-TinyLFU's sketch estimate), or -1 if it keeps none
+    virtual int keyFrequency(const std::string& key) const { (void)key; return -1; }
+    
+    // Hint that the keys of ops [first, last) are about to be accessed: warm
+    // the lines their lookups will touch without changing any state
+    // (see Simulator::applyBatch)
+    virtual void prefetch(const TraceOp* first, const TraceOp* last) const { (void)first; (void)last; }
+    
+    // Independent deep copy of the full replacement state (for checkpoints)
+    virtual std::unique_ptr<IPolicy> clone() const = 0;
 };
 
 struct SimConfig {
     size_t capacity;
     bool animate;           // true = record every step
     size_t snapshotEvery;   // e.g., 1000 for fast mode
+    uint64_t byteCapacity = 0; // > 0 = also bound the cache by total object bytes
+    bool trackBytes = false;   // report byte stats even without a byte budget
+    size_t metricsWindow = 0;  // > 0 = collect a TimeSeries with this many ops per window
+    double metricsAlpha = 0.0; // EWMA weight for smoothed miss ratio (0 = off)
+    uint64_t stepBudget = 0;   // > 0 = bound the estimated bytes of recorded steps
+    size_t prefetchBatch = 0;  // > 0 = prefetch the hash probes of this many ops ahead
+};
+
+// Compact per-window counters collected during a run. Holds at most
+// TimeSeriesRecorder::kMaxWindows windows; when full, adjacent windows are
+// merged and `window` doubles, so memory stays fixed for any trace length.
+struct TimeSeries {
+    size_t window = 0; // ops per window
+    std::vector<uint32_t> hits, misses, evictions;
+    std::vector<int32_t> arcP, lfuMinFrequency; // sampled at window end, -1 = n/a
+    std::vector<float> smoothedMissRatio;       // EWMA of per-window miss ratio, if enabled
+};
+
+// How densely a run's steps were recorded. Steps exist for every
+// stride-th op plus the final op; stride exceeds requestedStride when the
+// steps would not fit SimConfig::stepBudget.
+struct RecordingFidelity {
+    size_t requestedStride = 1; // 1 in animate mode, snapshotEvery in fast mode
+    size_t stride = 1;
+    size_t steps = 0;           // steps (or snapshots) kept
+    uint64_t bytes = 0;         // their estimated memory
+    uint64_t budget = 0;        // 0 = unlimited
 };
 
 struct SimResult {
     std::vector<Step> steps;     // empty if fast mode
     std::vector<Step> snapshots; // sparse steps if fast mode
     Stats stats;
+    TimeSeries series;           // empty unless SimConfig::metricsWindow > 0
+    RecordingFidelity fidelity;
 };
 
 } // namespace cachesim
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../include/types.hpp"
+#include "prefetch.hpp"
 #include <list>
 #include <unordered_map>
 
@@ -25,6 +26,46 @@ private:
     std::unordered_map<std::string, std::list<std::string>::iterator> T2_iterators_;
     std::unordered_map<std::string, std::list<std::string>::iterator> B1_iterators_;
     std::unordered_map<std::string, std::list<std::string>::iterator> B2_iterators_;
+    
+    uint64_t hit_path_writes_ = 0;
+
+    static void reindexList(std::list<std::string>& list,
+                            std::unordered_map<std::string, std::list<std::string>::iterator>& index) {
+        for (auto it = list.begin(); it != list.end(); ++it) {
+            index[*it] = it;
+        }
+    }
+
+    void reindex() {
+        reindexList(T1_, T1_iterators_);
+        reindexList(T2_, T2_iterators_);
+        reindexList(B1_, B1_iterators_);
+        reindexList(B2_, B2_iterators_);
+    }
+
+    // Removes `key` from B1/B2, adapting p as for a ghost hit; returns
+    // whether it was a ghost
+    bool takeGhost(const std::string& key) {
+        auto b1_it = B1_iterators_.find(key);
+        if (b1_it != B1_iterators_.end()) {
+            // Hit in B1 - increase p (toward recency)
+            p_ = std::min(p_ + 1, static_cast<int>(capacity_));
+            B1_.erase(b1_it->second);
+            B1_iterators_.erase(b1_it);
+            return true;
+        }
+        
+        auto b2_it = B2_iterators_.find(key);
+        if (b2_it != B2_iterators_.end()) {
+            // Hit in B2 - decrease p (toward frequency)
+            p_ = std::max(p_ - 1, 0);
+            B2_.erase(b2_it->second);
+            B2_iterators_.erase(b2_it);
+            return true;
+        }
+        
+        return false;
+    }
 
 public:
     explicit ARCPolicy(size_t capacity) : capacity_(capacity), p_(0) {}
@@ -39,6 +80,7 @@ public:
             
             T2_.push_front(key);
             T2_iterators_[key] = T2_.begin();
+            ++hit_path_writes_;
             
             outVal = values_[key];
             return true;
@@ -48,41 +90,17 @@ public:
         auto t2_it = T2_iterators_.find(key);
         if (t2_it != T2_iterators_.end()) {
             // Hit in T2 - move to front
-            T2_.erase(t2_it->second);
-            T2_.push_front(key);
-            t2_it->second = T2_.begin();
-            
-            outVal = values_[key];
-            return true;
-        }
-        
-        // Check B1
-        auto b1_it = B1_iterators_.find(key);
-        if (b1_it != B1_iterators_.end()) {
-            // Hit in B1 - increase p (toward recency)
-            p_ = std::min(p_ + 1, static_cast<int>(capacity_));
-            
-            // Move from B1 to T2
-            B1_.erase(b1_it->second);
-            B1_iterators_.erase(b1_it);
-            
-            T2_.push_front(key);
-            T2_iterators_[key] = T2_.begin();
+            if (t2_it->second != T2_.begin()) {
+                T2_.splice(T2_.begin(), T2_, t2_it->second);
+                ++hit_path_writes_;
+            }
             
             outVal = values_[key];
             return true;
         }
         
-        // Check B2
-        auto b2_it = B2_iterators_.find(key);
-        if (b2_it != B2_iterators_.end()) {
-            // Hit in B2 - decrease p (toward frequency)
-            p_ = std::max(p_ - 1, 0);
-            
-            // Move from B2 to T2
-            B2_.erase(b2_it->second);
-            B2_iterators_.erase(b2_it);
-            
+        // Check B1 and B2 - move a ghost to T2
+        if (takeGhost(key)) {
             T2_.push_front(key);
             T2_iterators_[key] = T2_.begin();
             
@@ -106,31 +124,20 @@ public:
             return evicted;
         }
         
+        if (takeGhost(key)) {
+            // Ghost key - re-admit into T2 as get() would, making room first
+            if (T1_.size() + T2_.size() >= capacity_) {
+                evicted = evict();
+            }
+            T2_.push_front(key);
+            T2_iterators_[key] = T2_.begin();
+            values_[key] = val;
+            return evicted;
+        }
+        
         // New key - check if we need to evict
         if (T1_.size() + T2_.size() >= capacity_) {
-            if (static_cast<int>(T1_.size()) > p_) {
-                // Evict from T1
-                std::string evicted_key = T1_.back();
-                T1_.pop_back();
-                T1_iterators_.erase(evicted_key);
-                
-                // Move to B1
-                B1_.push_front(evicted_key);
-                B1_iterators_[evicted_key] = B1_.begin();
-                
-                evicted = evicted_key;
-            } else {
-                // Evict from T2
-                std::string evicted_key = T2_.back();
-                T2_.pop_back();
-                T2_iterators_.erase(evicted_key);
-                
-                // Move to B2
-                B2_.push_front(evicted_key);
-                B2_iterators_[evicted_key] = B2_.begin();
-                
-                evicted = evicted_key;
-            }
+            evicted = evict();
         }
         
         // Clean up ghost lists if they exceed capacity
@@ -156,6 +163,50 @@ public:
         return evicted;
     }
     
+    std::optional<std::string> evict() override {
+        if (T1_.empty() && T2_.empty()) {
+            return std::nullopt;
+        }
+        
+        if (!T1_.empty() && (static_cast<int>(T1_.size()) > p_ || T2_.empty())) {
+            // Evict from T1
+            std::string evicted_key = T1_.back();
+            T1_.pop_back();
+            T1_iterators_.erase(evicted_key);
+            
+            // Move to B1
+            B1_.push_front(evicted_key);
+            B1_iterators_[evicted_key] = B1_.begin();
+            
+            return evicted_key;
+        }
+        
+        // Evict from T2
+        std::string evicted_key = T2_.back();
+        T2_.pop_back();
+        T2_iterators_.erase(evicted_key);
+        
+        // Move to B2
+        B2_.push_front(evicted_key);
+        B2_iterators_[evicted_key] = B2_.begin();
+        
+        return evicted_key;
+    }
+    
+    bool erase(const std::string& key) override {
+        // Only resident keys; a dropped key leaves no ghost behind
+        for (auto* index : {&T1_iterators_, &T2_iterators_}) {
+            auto it = index->find(key);
+            if (it != index->end()) {
+                (index == &T1_iterators_ ? T1_ : T2_).erase(it->second);
+                index->erase(it);
+                values_.erase(key);
+                return true;
+            }
+        }
+        return false;
+    }
+    
     std::vector<std::pair<std::string, std::string>> snapshot() const override {
         std::vector<std::pair<std::string, std::string>> result;
         result.reserve(T1_.size() + T2_.size());
@@ -188,6 +239,30 @@ public:
         return T1_iterators_.find(key) != T1_iterators_.end() || 
                T2_iterators_.find(key) != T2_iterators_.end();
     }
+
+    uint64_t hitPathWrites() const override { return hit_path_writes_; }
+
+    void prefetch(const TraceOp* first, const TraceOp* last) const override {
+        // get() probes the four lists in turn before reading the value
+        auto listNode = [](const auto& entry) { prefetchLine(&*entry.second); };
+        for (const auto* index : {&T1_iterators_, &T2_iterators_, &B1_iterators_, &B2_iterators_}) {
+            prefetchProbes(*index, first, last, listNode);
+        }
+        prefetchProbes(values_, first, last, [](const auto& entry) { prefetchLine(entry.second.data()); });
+    }
+
+    std::unique_ptr<IPolicy> clone() const override {
+        // The implicit copy still points into our lists; re-point it at its own
+        auto copy = std::make_unique<ARCPolicy>(*this);
+        copy->reindex();
+        return copy;
+    }
+    
+    PolicyGauges gauges() const override {
+        PolicyGauges g;
+        g.arcP = p_;
+        return g;
+    }
 };
 
 } // namespace cachesim
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+
+namespace cachesim {
+
+// Counters reported by the concurrent cache engines. Unlike Stats these
+// are summed from per-thread counter shards, so a snapshot taken while
+// other threads are running is approximate.
+struct ConcurrentCacheStats {
+    uint64_t hits = 0, misses = 0, evictions = 0;
+    uint64_t lockAcquisitions = 0; // shared + exclusive
+    uint64_t contendedAcquisitions = 0; // acquisitions that had to block
+    uint64_t drains = 0; // batched recency drains (LRU only)
+
+    double hitRatio() const {
+        auto total = hits + misses;
+        return total ? double(hits) / double(total) : 0.0;
+    }
+
+    double contentionRatio() const {
+        return lockAcquisitions ? double(contendedAcquisitions) / double(lockAcquisitions) : 0.0;
+    }
+};
+
+namespace concurrent_detail {
+
+inline size_t stripeCountFor(size_t requested) {
+    size_t n = 1;
+    while (n < requested) n <<= 1;
+    return n;
+}
+
+inline size_t stripeIndex(const std::string& key, size_t stripeMask) {
+    uint64_t h = std::hash<std::string>{}(key);
+    h *= 0x9E3779B97F4A7C15ULL;
+    return static_cast<size_t>(h >> 40) & stripeMask;
+}
+
+// One thread's share of a cache's counters, on its own cache line, so
+// counting never writes a line that other threads touch
+struct alignas(64) CounterShard {
+    std::atomic<uint64_t> hits{0}, misses{0}, evictions{0};
+    std::atomic<uint64_t> acquisitions{0}, contended{0}, drains{0};
+
+    static void bump(std::atomic<uint64_t>& counter) {
+        counter.fetch_add(1, std::memory_order_relaxed);
+    }
+};
+
+// Counter shards of one cache, indexed by a per-thread slot (threads beyond
+// kShards share shards)
+class Counters {
+public:
+    static constexpr size_t kShards = 64;
+
+    CounterShard& local() {
+        static std::atomic<size_t> nextSlot{0};
+        thread_local size_t slot = nextSlot.fetch_add(1, std::memory_order_relaxed);
+        return shards_[slot % kShards];
+    }
+
+    void addTo(ConcurrentCacheStats& stats) const {
+        for (const auto& shard : shards_) {
+            stats.hits += shard.hits.load(std::memory_order_relaxed);
+            stats.misses += shard.misses.load(std::memory_order_relaxed);
+            stats.evictions += shard.evictions.load(std::memory_order_relaxed);
+            stats.lockAcquisitions += shard.acquisitions.load(std::memory_order_relaxed);
+            stats.contendedAcquisitions += shard.contended.load(std::memory_order_relaxed);
+            stats.drains += shard.drains.load(std::memory_order_relaxed);
+        }
+    }
+
+private:
+    CounterShard shards_[kShards];
+};
+
+// Per-stripe lock; aligned so stripes never share a cache line. Counting
+// goes to the caller's counter shard, so the only write a reader makes to
+// the stripe's line is the reader count inside the shared_mutex.
+struct alignas(64) StripeLock {
+    mutable std::shared_mutex mutex;
+
+    std::unique_lock<std::shared_mutex> lockExclusive(CounterShard& counters) const {
+        CounterShard::bump(counters.acquisitions);
+        std::unique_lock<std::shared_mutex> lock(mutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            CounterShard::bump(counters.contended);
+            lock.lock();
+        }
+        return lock;
+    }
+
+    std::shared_lock<std::shared_mutex> lockShared(CounterShard& counters) const {
+        CounterShard::bump(counters.acquisitions);
+        std::shared_lock<std::shared_mutex> lock(mutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            CounterShard::bump(counters.contended);
+            lock.lock();
+        }
+        return lock;
+    }
+};
+
+} // namespace concurrent_detail
+
+} // namespace cachesim
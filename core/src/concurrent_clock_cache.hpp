@@ -0,0 +1,134 @@
+#pragma once
+
+#include "concurrent_cache.hpp"
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace cachesim {
+
+// Thread-safe CLOCK cache (FIFO with second chance) built from independent
+// lock stripes. Each stripe is a fixed array of slots swept by a hand.
+//
+// Hits take only a shared (reader) lock and set the slot's reference bit
+// with a relaxed atomic store - and skip even that if the bit is already
+// set - so concurrent hits on hot keys do not bounce a write between
+// cores. Statistics go to per-thread counter shards. Misses take the
+// exclusive lock and advance the hand.
+class ConcurrentClockCache {
+private:
+    struct Slot {
+        std::string key;
+        std::string value;
+        std::atomic<uint8_t> referenced{0};
+    };
+
+    struct Stripe : concurrent_detail::StripeLock {
+        alignas(64) size_t capacity = 0; // off the lock's line
+        std::unique_ptr<Slot[]> slots;
+        std::unordered_map<std::string, size_t> map; // key -> slot index
+        size_t hand = 0;
+        size_t used = 0;
+    };
+
+    std::unique_ptr<Stripe[]> stripes_;
+    size_t stripe_mask_;
+    concurrent_detail::Counters counters_;
+
+    Stripe& stripeFor(const std::string& key) const {
+        return stripes_[concurrent_detail::stripeIndex(key, stripe_mask_)];
+    }
+
+    // Caller holds the exclusive lock and the stripe is full
+    static size_t findVictim(Stripe& stripe) {
+        for (;;) {
+            Slot& slot = stripe.slots[stripe.hand];
+            size_t index = stripe.hand;
+            stripe.hand = (stripe.hand + 1) % stripe.capacity;
+            if (!slot.referenced.load(std::memory_order_relaxed)) {
+                return index;
+            }
+            slot.referenced.store(0, std::memory_order_relaxed);
+        }
+    }
+
+public:
+    ConcurrentClockCache(size_t capacity, size_t stripes) {
+        if (capacity == 0) {
+            throw std::invalid_argument("Capacity must be greater than 0");
+        }
+        size_t count = concurrent_detail::stripeCountFor(stripes);
+        while (count > 1 && count > capacity) count >>= 1;
+        stripes_ = std::make_unique<Stripe[]>(count);
+        stripe_mask_ = count - 1;
+        for (size_t i = 0; i < count; ++i) {
+            Stripe& stripe = stripes_[i];
+            stripe.capacity = capacity / count + (i < capacity % count ? 1 : 0);
+            stripe.slots = std::make_unique<Slot[]>(stripe.capacity);
+            stripe.map.reserve(stripe.capacity);
+        }
+    }
+
+    bool get(const std::string& key, std::string& outVal) {
+        Stripe& stripe = stripeFor(key);
+        auto& counters = counters_.local();
+        {
+            auto lock = stripe.lockShared(counters);
+            auto it = stripe.map.find(key);
+            if (it == stripe.map.end()) {
+                concurrent_detail::CounterShard::bump(counters.misses);
+                return false; // miss
+            }
+            Slot& slot = stripe.slots[it->second];
+            outVal = slot.value;
+            if (!slot.referenced.load(std::memory_order_relaxed)) {
+                slot.referenced.store(1, std::memory_order_relaxed);
+            }
+        }
+        concurrent_detail::CounterShard::bump(counters.hits);
+        return true; // hit
+    }
+
+    std::optional<std::string> put(const std::string& key, const std::string& val) {
+        Stripe& stripe = stripeFor(key);
+        auto& counters = counters_.local();
+        auto lock = stripe.lockExclusive(counters);
+
+        auto it = stripe.map.find(key);
+        if (it != stripe.map.end()) {
+            Slot& slot = stripe.slots[it->second];
+            slot.value = val;
+            slot.referenced.store(1, std::memory_order_relaxed);
+            return std::nullopt;
+        }
+
+        std::optional<std::string> evicted;
+        size_t index;
+        if (stripe.used < stripe.capacity) {
+            index = stripe.used++;
+        } else {
+            index = findVictim(stripe);
+            evicted = std::move(stripe.slots[index].key);
+            stripe.map.erase(*evicted);
+            concurrent_detail::CounterShard::bump(counters.evictions);
+        }
+
+        Slot& slot = stripe.slots[index];
+        slot.key = key;
+        slot.value = val;
+        slot.referenced.store(0, std::memory_order_relaxed);
+        stripe.map[key] = index;
+        return evicted;
+    }
+
+    size_t stripeCount() const { return stripe_mask_ + 1; }
+
+    ConcurrentCacheStats stats() const {
+        ConcurrentCacheStats stats;
+        counters_.addTo(stats);
+        return stats;
+    }
+};
+
+} // namespace cachesim
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "concurrent_cache.hpp"
+#include <array>
+#include <list>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace cachesim {
+
+// Thread-safe LRU cache built from independent lock stripes.
+//
+// Hits take only a shared (reader) lock and never touch the recency list.
+// Instead they record the node in a small lossy per-stripe buffer with one
+// relaxed atomic store. Statistics go to per-thread counter shards, and the
+// buffer's tail sits on its own cache line, so a hit writes no line shared
+// with the stripe's lock or table besides the reader count. Whoever next holds the stripe exclusively - a
+// writer, or a reader that notices the buffer filling up - replays the
+// buffered hits as move-to-front operations in one batch. Recency is
+// therefore approximate under load, as in Caffeine-style caches.
+class ConcurrentLRUCache {
+private:
+    struct Node {
+        std::string key;
+        std::string value;
+        Node(const std::string& k, const std::string& v) : key(k), value(v) {}
+    };
+
+    static constexpr size_t kReadBufferSize = 64;
+    static constexpr uint64_t kDrainThreshold = kReadBufferSize / 2;
+
+    struct Stripe : concurrent_detail::StripeLock {
+        // Read by every hit, written under the exclusive lock
+        alignas(64) size_t capacity = 0;
+        std::list<Node> recency; // MRU -> ... -> LRU
+        std::unordered_map<std::string, std::list<Node>::iterator> map;
+        uint64_t drainedTail = 0;
+
+        // Written by hits
+        alignas(64) std::array<std::atomic<Node*>, kReadBufferSize> readBuffer{};
+        alignas(64) std::atomic<uint64_t> readTail{0};
+    };
+
+    std::unique_ptr<Stripe[]> stripes_;
+    size_t stripe_mask_;
+    concurrent_detail::Counters counters_;
+
+    Stripe& stripeFor(const std::string& key) const {
+        return stripes_[concurrent_detail::stripeIndex(key, stripe_mask_)];
+    }
+
+    // Caller holds the exclusive lock
+    static void drainReadBuffer(Stripe& stripe, concurrent_detail::CounterShard& counters) {
+        uint64_t tail = stripe.readTail.load(std::memory_order_relaxed);
+        if (tail == stripe.drainedTail) {
+            return;
+        }
+        for (auto& slot : stripe.readBuffer) {
+            Node* node = slot.exchange(nullptr, std::memory_order_relaxed);
+            if (node) {
+                auto it = stripe.map.find(node->key);
+                if (it != stripe.map.end()) {
+                    stripe.recency.splice(stripe.recency.begin(), stripe.recency, it->second);
+                }
+            }
+        }
+        stripe.drainedTail = tail;
+        concurrent_detail::CounterShard::bump(counters.drains);
+    }
+
+public:
+    ConcurrentLRUCache(size_t capacity, size_t stripes) {
+        if (capacity == 0) {
+            throw std::invalid_argument("Capacity must be greater than 0");
+        }
+        size_t count = concurrent_detail::stripeCountFor(stripes);
+        while (count > 1 && count > capacity) count >>= 1;
+        stripes_ = std::make_unique<Stripe[]>(count);
+        stripe_mask_ = count - 1;
+        for (size_t i = 0; i < count; ++i) {
+            stripes_[i].capacity = capacity / count + (i < capacity % count ? 1 : 0);
+            stripes_[i].map.reserve(stripes_[i].capacity);
+        }
+    }
+
+    bool get(const std::string& key, std::string& outVal) {
+        Stripe& stripe = stripeFor(key);
+        auto& counters = counters_.local();
+        bool needDrain = false;
+        {
+            auto lock = stripe.lockShared(counters);
+            auto it = stripe.map.find(key);
+            if (it == stripe.map.end()) {
+                concurrent_detail::CounterShard::bump(counters.misses);
+                return false; // miss
+            }
+            outVal = it->second->value;
+
+            // Record the hit; drains happen under the exclusive lock, so the
+            // node cannot be freed while we still hold the shared lock
+            uint64_t ticket = stripe.readTail.fetch_add(1, std::memory_order_relaxed);
+            stripe.readBuffer[ticket % kReadBufferSize].store(&*it->second, std::memory_order_relaxed);
+            needDrain = ticket - stripe.drainedTail >= kDrainThreshold;
+        }
+        concurrent_detail::CounterShard::bump(counters.hits);
+
+        if (needDrain) {
+            // Opportunistic: skip if someone else holds the stripe
+            std::unique_lock<std::shared_mutex> lock(stripe.mutex, std::try_to_lock);
+            if (lock.owns_lock()) {
+                drainReadBuffer(stripe, counters);
+            }
+        }
+        return true; // hit
+    }
+
+    std::optional<std::string> put(const std::string& key, const std::string& val) {
+        Stripe& stripe = stripeFor(key);
+        auto& counters = counters_.local();
+        auto lock = stripe.lockExclusive(counters);
+        drainReadBuffer(stripe, counters);
+
+        auto it = stripe.map.find(key);
+        if (it != stripe.map.end()) {
+            it->second->value = val;
+            stripe.recency.splice(stripe.recency.begin(), stripe.recency, it->second);
+            return std::nullopt;
+        }
+
+        std::optional<std::string> evicted;
+        if (stripe.recency.size() >= stripe.capacity) {
+            evicted = std::move(stripe.recency.back().key);
+            stripe.map.erase(*evicted);
+            stripe.recency.pop_back();
+            concurrent_detail::CounterShard::bump(counters.evictions);
+        }
+
+        stripe.recency.emplace_front(key, val);
+        stripe.map[key] = stripe.recency.begin();
+        return evicted;
+    }
+
+    size_t stripeCount() const { return stripe_mask_ + 1; }
+
+    ConcurrentCacheStats stats() const {
+        ConcurrentCacheStats stats;
+        counters_.addTo(stats);
+        return stats;
+    }
+};
+
+} // namespace cachesim
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../include/types.hpp"
+#include "prefetch.hpp"
 #include <queue>
 #include <unordered_map>
 
@@ -8,9 +9,36 @@ namespace cachesim {
 
 class FIFOPolicy : public IPolicy {
 private:
+    // Queue slots carry the insertion seq of their entry; a slot whose key
+    // was erased (or erased and re-inserted) no longer matches and is skipped.
+    // Stale slots are compacted away once they outnumber live entries.
+    struct Entry {
+        std::string value;
+        uint64_t seq;
+    };
+    
     size_t capacity_;
-    std::queue<std::string> arrival_order_;
-    std::unordered_map<std::string, std::string> key_value_map_;
+    uint64_t seq_ = 0;
+    size_t stale_slots_ = 0;
+    std::queue<std::pair<std::string, uint64_t>> arrival_order_;
+    std::unordered_map<std::string, Entry> key_value_map_;
+    
+    bool isLive(const std::pair<std::string, uint64_t>& slot) const {
+        auto it = key_value_map_.find(slot.first);
+        return it != key_value_map_.end() && it->second.seq == slot.second;
+    }
+
+    void compact() {
+        std::queue<std::pair<std::string, uint64_t>> live;
+        while (!arrival_order_.empty()) {
+            if (isLive(arrival_order_.front())) {
+                live.push(std::move(arrival_order_.front()));
+            }
+            arrival_order_.pop();
+        }
+        arrival_order_ = std::move(live);
+        stale_slots_ = 0;
+    }
 
 public:
     explicit FIFOPolicy(size_t capacity) : capacity_(capacity) {}
@@ -22,49 +50,73 @@ public:
         }
         
         // Hit - return value but don't change order
-        outVal = it->second;
+        outVal = it->second.value;
         return true; // hit
     }
     
     std::optional<std::string> put(const std::string& key, const std::string& val) override {
         std::optional<std::string> evicted;
         
-        if (key_value_map_.find(key) == key_value_map_.end()) {
-            // New key
-            if (key_value_map_.size() >= capacity_) {
-                // Evict oldest (front of queue)
-                evicted = arrival_order_.front();
-                key_value_map_.erase(evicted.value());
-                arrival_order_.pop();
-            }
-            
-            // Add new key to queue and map
-            arrival_order_.push(key);
+        auto it = key_value_map_.find(key);
+        if (it != key_value_map_.end()) {
+            // Update value (order unchanged for existing keys)
+            it->second.value = val;
+            return evicted;
+        }
+        
+        // New key
+        if (key_value_map_.size() >= capacity_) {
+            evicted = evict();
         }
         
-        // Update or insert value (order unchanged for existing keys)
-        key_value_map_[key] = val;
+        // Add new key to queue and map
+        arrival_order_.emplace(key, seq_);
+        key_value_map_[key] = Entry{val, seq_++};
         
         return evicted;
     }
     
+    std::optional<std::string> evict() override {
+        // Skip slots of erased keys
+        while (!arrival_order_.empty() && !isLive(arrival_order_.front())) {
+            arrival_order_.pop();
+            --stale_slots_;
+        }
+        if (arrival_order_.empty()) {
+            return std::nullopt;
+        }
+        
+        // Evict oldest (front of queue)
+        std::string key = std::move(arrival_order_.front().first);
+        key_value_map_.erase(key);
+        arrival_order_.pop();
+        return key;
+    }
+    
+    bool erase(const std::string& key) override {
+        // The queue slot goes stale and is dropped when it reaches the front
+        if (key_value_map_.erase(key) == 0) {
+            return false;
+        }
+        if (++stale_slots_ > key_value_map_.size() + 8) {
+            compact();
+        }
+        return true;
+    }
+    
     std::vector<std::pair<std::string, std::string>> snapshot() const override {
         std::vector<std::pair<std::string, std::string>> result;
         result.reserve(key_value_map_.size());
         
         // Create a copy of the queue to iterate
-        std::queue<std::string> temp_queue = arrival_order_;
-        std::unordered_map<std::string, std::string> temp_map = key_value_map_;
+        auto temp_queue = arrival_order_;
         
         while (!temp_queue.empty()) {
-            std::string key = temp_queue.front();
-            temp_queue.pop();
-            
-            auto it = temp_map.find(key);
-            if (it != temp_map.end()) {
-                result.emplace_back(key, it->second);
-                temp_map.erase(it); // Remove to avoid duplicates
+            if (isLive(temp_queue.front())) {
+                const std::string& key = temp_queue.front().first;
+                result.emplace_back(key, key_value_map_.at(key).value);
             }
+            temp_queue.pop();
         }
         
         return result;
@@ -73,6 +125,16 @@ public:
     bool isCacheHit(const std::string& key) const override {
         return key_value_map_.find(key) != key_value_map_.end();
     }
+    
+    void prefetch(const TraceOp* first, const TraceOp* last) const override {
+        // A hit only reads the map node and its value
+        prefetchProbes(key_value_map_, first, last,
+                       [](const auto& entry) { prefetchLine(entry.second.value.data()); });
+    }
+    
+    std::unique_ptr<IPolicy> clone() const override {
+        return std::make_unique<FIFOPolicy>(*this);
+    }
 };
 
 } // namespace cachesim
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "../include/types.hpp"
+#include <map>
+#include <unordered_map>
+
+namespace cachesim {
+
+// GreedyDual-Size-Frequency: each entry's priority is
+//     H = L + frequency / size
+// and the lowest-H entry is evicted. L (the "inflation" value) is raised to
+// the victim's H on every eviction, so entries that stop being accessed age
+// out relative to newly inserted ones. Small, popular objects win.
+// Priorities live in an ordered map, so hits and evictions are O(log n).
+class GDSFPolicy : public IPolicy {
+private:
+    using QueueKey = std::pair<double, uint64_t>; // (priority, insertion seq for FIFO ties)
+
+    struct Entry {
+        std::string value;
+        uint64_t size;
+        uint64_t frequency;
+        std::map<QueueKey, std::string>::iterator pos;
+    };
+
+    size_t capacity_;
+    double inflation_ = 0.0; // L
+    uint64_t seq_ = 0;
+    std::map<QueueKey, std::string> queue_; // lowest priority first
+    std::unordered_map<std::string, Entry> entries_;
+    uint64_t hit_path_writes_ = 0;
+
+    double priorityOf(const Entry& entry) const {
+        return inflation_ + double(entry.frequency) / double(entry.size ? entry.size : 1);
+    }
+
+    void reindex() {
+        for (auto it = queue_.begin(); it != queue_.end(); ++it) {
+            entries_.at(it->second).pos = it;
+        }
+    }
+
+    void reprioritize(const std::string& key, Entry& entry) {
+        queue_.erase(entry.pos);
+        entry.pos = queue_.emplace(QueueKey{priorityOf(entry), seq_++}, key).first;
+    }
+
+public:
+    explicit GDSFPolicy(size_t capacity) : capacity_(capacity) {
+        entries_.reserve(capacity);
+    }
+
+    bool get(const std::string& key, std::string& outVal) override {
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            return false; // miss
+        }
+
+        // Hit - bump frequency and recompute priority against the current L
+        Entry& entry = it->second;
+        entry.frequency++;
+        reprioritize(key, entry);
+        ++hit_path_writes_;
+
+        outVal = entry.value;
+        return true; // hit
+    }
+
+    std::optional<std::string> put(const std::string& key, const std::string& val) override {
+        return putSized(key, val, val.size());
+    }
+
+    std::optional<std::string> putSized(const std::string& key, const std::string& val, uint64_t size) override {
+        auto it = entries_.find(key);
+        if (it != entries_.end()) {
+            // Key exists - update value/size and treat as access
+            Entry& entry = it->second;
+            entry.value = val;
+            entry.size = size;
+            entry.frequency++;
+            reprioritize(key, entry);
+            return std::nullopt;
+        }
+
+        std::optional<std::string> evicted;
+        if (entries_.size() >= capacity_) {
+            evicted = evict();
+        }
+
+        Entry& entry = entries_[key];
+        entry.value = val;
+        entry.size = size;
+        entry.frequency = 1;
+        entry.pos = queue_.emplace(QueueKey{priorityOf(entry), seq_++}, key).first;
+
+        return evicted;
+    }
+
+    std::optional<std::string> evict() override {
+        if (queue_.empty()) {
+            return std::nullopt;
+        }
+
+        auto victim = queue_.begin();
+        inflation_ = victim->first.first;
+        std::string key = std::move(victim->second);
+        queue_.erase(victim);
+        entries_.erase(key);
+        return key;
+    }
+
+    bool erase(const std::string& key) override {
+        // L is only inflated by evictions
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            return false;
+        }
+        queue_.erase(it->second.pos);
+        entries_.erase(it);
+        return true;
+    }
+
+    std::vector<std::pair<std::string, std::string>> snapshot() const override {
+        std::vector<std::pair<std::string, std::string>> result;
+        result.reserve(entries_.size());
+
+        // Highest priority first
+        for (auto it = queue_.rbegin(); it != queue_.rend(); ++it) {
+            result.emplace_back(it->second, entries_.at(it->second).value);
+        }
+
+        return result;
+    }
+
+    void metaForUI(Step& s) const override {
+        for (const auto& [key, entry] : entries_) {
+            s.freq[key] = static_cast<int>(entry.frequency);
+        }
+    }
+
+    bool isCacheHit(const std::string& key) const override {
+        return entries_.find(key) != entries_.end();
+    }
+
+    uint64_t hitPathWrites() const override { return hit_path_writes_; }
+
+    std::unique_ptr<IPolicy> clone() const override {
+        // The implicit copy still points into our lists; re-point it at its own
+        auto copy = std::make_unique<GDSFPolicy>(*this);
+        copy->reindex();
+        return copy;
+    }
+};
+
+} // namespace cachesim
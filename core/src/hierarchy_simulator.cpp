@@ -0,0 +1,202 @@
+#include "hierarchy_simulator.hpp"
+#include <stdexcept>
+
+namespace cachesim {
+
+Inclusion HierarchySimulator::parseInclusion(const std::string& name) {
+    if (name == "inclusive") return Inclusion::Inclusive;
+    if (name == "exclusive") return Inclusion::Exclusive;
+    if (name == "nine") return Inclusion::NINE;
+    throw std::runtime_error("Unknown inclusion: " + name);
+}
+
+HierarchyResult HierarchySimulator::run(const std::vector<TraceOp>& ops, const std::vector<IPolicy*>& levels,
+                                        const std::vector<size_t>& capacities, const HierarchyConfig& config) {
+    if (levels.size() < 2) {
+        throw std::runtime_error("A hierarchy needs at least two levels");
+    }
+    if (capacities.size() != levels.size()) {
+        throw std::runtime_error("Expected one capacity per level");
+    }
+
+    levels_ = levels;
+    config_ = config;
+    result_ = HierarchyResult{};
+    result_.levels.resize(levels.size());
+    for (size_t i = 0; i < levels.size(); ++i) {
+        result_.levels[i].capacity = capacities[i];
+    }
+    objects_.clear();
+
+    for (const auto& op : ops) {
+        if (op.kind == TraceOp::Kind::GET) {
+            get(op);
+        } else if (op.kind == TraceOp::Kind::DEL) {
+            remove(op.key);
+        } else {
+            put(op);
+        }
+        enforceInclusion(op.key);
+    }
+
+    for (size_t i = 0; i < levels_.size(); ++i) {
+        result_.levels[i].stats.hitPathWrites = levels_[i]->hitPathWrites();
+        result_.stats.hitPathWrites += result_.levels[i].stats.hitPathWrites;
+    }
+    objects_.clear();
+    return std::move(result_);
+}
+
+void HierarchySimulator::get(const TraceOp& op) {
+    size_t n = levels_.size();
+    size_t hitLevel = n;
+    std::string value;
+    for (size_t i = 0; i < n; ++i) {
+        // Same hit test as Simulator::applyOp: an ARC ghost hit re-admits
+        // the key at that level but counts as a miss
+        Stats& stats = result_.levels[i].stats;
+        bool wasInCache = levels_[i]->isCacheHit(op.key);
+        bool found = levels_[i]->get(op.key, value);
+        if (found && wasInCache) {
+            stats.hits++;
+            hitLevel = i;
+            break;
+        }
+        stats.misses++;
+        if (found) stats.ghostHits++;
+    }
+
+    if (hitLevel < n) {
+        result_.stats.hits++;
+        objects_[op.key].value = value;
+    } else {
+        result_.stats.misses++;
+        if (!op.fill) {
+            return;
+        }
+        // Demand fill: the value comes from the backing store (defaults to the key)
+        Object& object = objects_[op.key];
+        object.value = op.value.empty() ? op.key : op.value;
+        if (op.size || !object.size) {
+            object.size = op.size ? op.size : object.value.size();
+        }
+    }
+
+    if (hitLevel == 0) {
+        return;
+    }
+    if (config_.inclusion == Inclusion::Exclusive) {
+        // Move the key up to L1
+        if (hitLevel < n) {
+            levels_[hitLevel]->erase(op.key);
+        }
+        insert(0, op.key);
+        return;
+    }
+
+    // Copy into every level above the hit, bottom-up so inclusion holds throughout
+    for (size_t j = hitLevel; j-- > 0;) {
+        if (!levels_[j]->isCacheHit(op.key)) {
+            insert(j, op.key);
+        }
+    }
+}
+
+void HierarchySimulator::put(const TraceOp& op) {
+    objects_[op.key] = Object{op.value, op.objectSize()};
+    size_t n = levels_.size();
+    switch (config_.inclusion) {
+        case Inclusion::Inclusive:
+            // Write through every level, bottom-up
+            for (size_t j = n; j-- > 0;) {
+                insert(j, op.key);
+            }
+            break;
+        case Inclusion::Exclusive:
+            // Stale copies below go; the write lands in L1
+            for (size_t j = 1; j < n; ++j) {
+                levels_[j]->erase(op.key);
+            }
+            insert(0, op.key);
+            break;
+        case Inclusion::NINE:
+            // Write to L1 and update copies already below it
+            insert(0, op.key);
+            for (size_t j = 1; j < n; ++j) {
+                if (levels_[j]->isCacheHit(op.key)) {
+                    insert(j, op.key);
+                }
+            }
+            break;
+    }
+}
+
+void HierarchySimulator::remove(const std::string& key) {
+    // Every copy goes; not an eviction or an invalidation
+    for (IPolicy* level : levels_) {
+        level->erase(key);
+    }
+}
+
+void HierarchySimulator::insert(size_t level, const std::string& key) {
+    Object object = objects_.at(key); // copied: demotions below may rehash the map
+    auto victim = levels_[level]->putSized(key, object.value, object.size);
+    if (victim) {
+        result_.levels[level].stats.evictions++;
+        onEvict(level, *victim);
+    }
+}
+
+void HierarchySimulator::onEvict(size_t level, const std::string& victim) {
+    if (config_.inclusion == Inclusion::Inclusive) {
+        // Back-invalidate: upper levels may not hold what this level dropped
+        for (size_t i = 0; i < level; ++i) {
+            if (levels_[i]->erase(victim)) {
+                result_.invalidations++;
+            }
+        }
+    }
+
+    bool demote = config_.inclusion == Inclusion::Exclusive ||
+                  (config_.inclusion == Inclusion::NINE && config_.demote);
+    if (demote && level + 1 < levels_.size() && !levels_[level + 1]->isCacheHit(victim)) {
+        result_.demotions++;
+        insert(level + 1, victim);
+    }
+
+    if (!residentAnywhere(victim)) {
+        result_.stats.evictions++;
+    }
+}
+
+void HierarchySimulator::enforceInclusion(const std::string& key) {
+    // Evictions keep the invariant except where a policy admits or rejects
+    // keys on its own (ARC ghost hits, W-TinyLFU admission); fix up the
+    // op's key so those cases cannot leave it violated
+    size_t n = levels_.size();
+    if (config_.inclusion == Inclusion::Inclusive) {
+        for (size_t j = n - 1; j-- > 0;) {
+            if (!levels_[j + 1]->isCacheHit(key) && levels_[j]->erase(key)) {
+                result_.invalidations++;
+            }
+        }
+    } else if (config_.inclusion == Inclusion::Exclusive) {
+        bool seen = false;
+        for (size_t j = 0; j < n; ++j) {
+            if (!levels_[j]->isCacheHit(key)) continue;
+            if (seen && levels_[j]->erase(key)) {
+                result_.invalidations++;
+            }
+            seen = true;
+        }
+    }
+}
+
+bool HierarchySimulator::residentAnywhere(const std::string& key) const {
+    for (const IPolicy* level : levels_) {
+        if (level->isCacheHit(key)) return true;
+    }
+    return false;
+}
+
+} // namespace cachesim
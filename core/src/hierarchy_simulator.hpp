@@ -0,0 +1,67 @@
+#pragma once
+
+#include "../include/types.hpp"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace cachesim {
+
+// How the contents of adjacent levels relate
+enum class Inclusion {
+    Inclusive, // every key in level i is also in level i+1; lower evictions back-invalidate
+    Exclusive, // a key lives in at most one level; L1 victims always move down
+    NINE       // non-inclusive non-exclusive: no invariant is enforced
+};
+
+struct HierarchyConfig {
+    Inclusion inclusion = Inclusion::NINE;
+    bool demote = false; // NINE: a level's victims are inserted into the next level
+};
+
+struct LevelStats {
+    size_t capacity = 0;
+    Stats stats; // hits/misses count only the GETs that reached this level
+};
+
+struct HierarchyResult {
+    Stats stats;                    // combined: a hit in any level is a hit
+    std::vector<LevelStats> levels; // L1 first
+    uint64_t demotions = 0;         // victims moved into the next level
+    uint64_t invalidations = 0;     // copies dropped to keep the inclusion invariant
+};
+
+// Models a multi-level cache (e.g. an in-process L1 in front of a shared L2)
+// in one pass over the trace. Each level is any IPolicy. A GET probes the
+// levels in order until one hits; the key is then filled into the levels
+// above the hit (inclusive/NINE) or moved to L1 (exclusive). Combined
+// evictions count keys that left every level. Capacities are in entries.
+class HierarchySimulator {
+public:
+    // `levels` are L1 first and must be empty; `capacities` are for reporting
+    HierarchyResult run(const std::vector<TraceOp>& ops, const std::vector<IPolicy*>& levels,
+                        const std::vector<size_t>& capacities, const HierarchyConfig& config);
+
+    static Inclusion parseInclusion(const std::string& name);
+
+private:
+    struct Object {
+        std::string value;
+        uint64_t size;
+    };
+
+    std::vector<IPolicy*> levels_;
+    HierarchyConfig config_;
+    HierarchyResult result_;
+    std::unordered_map<std::string, Object> objects_; // latest value per key, for fills and demotions
+
+    void get(const TraceOp& op);
+    void put(const TraceOp& op);
+    void remove(const std::string& key);
+    void insert(size_t level, const std::string& key);
+    void onEvict(size_t level, const std::string& victim);
+    void enforceInclusion(const std::string& key);
+    bool residentAnywhere(const std::string& key) const;
+};
+
+} // namespace cachesim
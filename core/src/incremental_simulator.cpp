@@ -0,0 +1,206 @@
+#include "incremental_simulator.hpp"
+#include "count_min_sketch.hpp"
+#include <algorithm>
+
+namespace cachesim {
+
+namespace {
+
+// splitmix64 finalizer
+uint64_t mix(uint64_t h) {
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    return h ^ (h >> 31);
+}
+
+} // namespace
+
+IncrementalSimulator::IncrementalSimulator(std::unique_ptr<IPolicy> initial, const SimConfig& cfg,
+                                           uint64_t checkpointBudget)
+    : initial_(std::move(initial)), cfg_(cfg), checkpoint_budget_(checkpointBudget) {}
+
+void IncrementalSimulator::setCheckpointBudget(uint64_t budget) {
+    checkpoint_budget_ = budget;
+    thinCheckpoints(kMaxCheckpoints);
+}
+
+uint64_t IncrementalSimulator::retainedBytes() const {
+    return checkpointBytes() + last_.fidelity.bytes;
+}
+
+uint64_t IncrementalSimulator::checkpointBytes() const {
+    uint64_t bytes = 0;
+    for (const auto& checkpoint : checkpoints_) {
+        bytes += checkpoint.bytes;
+    }
+    return bytes;
+}
+
+std::vector<uint64_t> IncrementalSimulator::prefixHashes(const std::vector<TraceOp>& ops) {
+    std::vector<uint64_t> hashes(ops.size() + 1);
+    uint64_t h = 0;
+    hashes[0] = h;
+    for (size_t i = 0; i < ops.size(); ++i) {
+        const TraceOp& op = ops[i];
+        uint64_t opHash = FrequencySketch::hashKey(op.key) ^ (FrequencySketch::hashKey(op.value) * 31);
+        opHash ^= op.size * 0x9E3779B97F4A7C15ULL ^ op.timestamp * 0xC2B2AE3D27D4EB4FULL;
+        opHash ^= op.ttl * 0x165667B19E3779F9ULL;
+        opHash ^= (static_cast<uint64_t>(op.kind) << 1) | (op.fill ? 1 : 0);
+        h = mix(h * 0x100000001B3ULL ^ opHash);
+        hashes[i + 1] = h;
+    }
+    return hashes;
+}
+
+void IncrementalSimulator::setStepBudget(uint64_t budget) {
+    if (budget == cfg_.stepBudget) {
+        return;
+    }
+    cfg_.stepBudget = budget;
+    // Steps recorded before any thinning, and within the new budget, are
+    // what a fresh run would record too
+    bool thinned = last_.fidelity.stride != last_.fidelity.requestedStride;
+    while (!checkpoints_.empty() &&
+           (thinned || (budget > 0 && checkpoints_.back().state.recorder.fidelity().bytes > budget))) {
+        checkpoints_.pop_back();
+    }
+    for (auto& checkpoint : checkpoints_) {
+        checkpoint.state.recorder.setBudget(budget);
+    }
+}
+
+SimResult IncrementalSimulator::run(const std::vector<TraceOp>& ops,
+                                   std::shared_ptr<const std::vector<uint64_t>> hashes) {
+    if (!hashes) {
+        hashes = std::make_shared<const std::vector<uint64_t>>(prefixHashes(ops));
+    }
+    start(ops, std::move(hashes));
+    advance(ops.size());
+    return finish();
+}
+
+size_t IncrementalSimulator::start(const std::vector<TraceOp>& ops,
+                                   std::shared_ptr<const std::vector<uint64_t>> hashes) {
+    const SimConfig& cfg = cfg_;
+    const std::vector<uint64_t>& current = *hashes;
+
+    // Longest shared prefix: hashes chain, so once they differ they stay different
+    size_t lo = 0;
+    size_t hi = prefix_hashes_ ? std::min(current.size(), prefix_hashes_->size()) : 0;
+    while (lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (current[mid] == (*prefix_hashes_)[mid]) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    size_t common = lo > 0 ? lo - 1 : 0; // ops [0, common) are unchanged
+    // Resume from the newest checkpoint whose tagged prefix is unchanged; at
+    // least one op is always replayed so the final-op step is recorded. The
+    // steps before it must not have been thinned since (same recorder stride),
+    // nor by the final step of the trace it ended.
+    while (!checkpoints_.empty() &&
+           (checkpoints_.back().index > common || checkpoints_.back().index >= std::max<size_t>(ops.size(), 1) ||
+            checkpoints_.back().prefixHash != current[checkpoints_.back().index] ||
+            checkpoints_.back().state.recorder.stride() != last_.fidelity.stride ||
+            checkpoints_.back().state.recorder.finalThinned())) {
+        checkpoints_.pop_back();
+    }
+
+    Pass pass;
+    pass.ops = &ops;
+    pass.at = 0;
+    if (checkpoints_.empty()) {
+        pass.policy = initial_->clone();
+        pass.state = Simulator::initialState(cfg);
+    } else {
+        const Checkpoint& cp = checkpoints_.back();
+        pass.at = cp.index;
+        pass.policy = cp.policy->clone();
+        pass.state = cp.state;
+        std::vector<Step>& steps = cfg.animate ? pass.result.steps : pass.result.snapshots;
+        steps = std::move(cfg.animate ? last_.steps : last_.snapshots);
+        // A checkpoint taken at the end of a trace counts that trace's
+        // off-grid final step, which a later run may have replaced with one
+        // past the checkpoint; the recorder drops either kind
+        steps.resize(std::min(steps.size(), cp.steps));
+        pass.state.recorder.resumeAt(pass.at, steps);
+    }
+    resumed_from_ = pass.at;
+    
+    // Checkpoints hold up to `capacity` entries; space them so that many
+    // full-size ones fit the budget
+    size_t sample = std::min<size_t>(ops.size(), 1024);
+    uint64_t sampleBytes = 0;
+    for (size_t i = 0; i < sample; ++i) {
+        sampleBytes += 2 * ops[i].key.size() + ops[i].value.size(); // the key is often held twice
+    }
+    entry_bytes_ = kPolicyEntryBytes + (sample ? sampleBytes / sample : 0);
+    pass.maxCheckpoints = kMaxCheckpoints;
+    if (checkpoint_budget_ > 0) {
+        uint64_t full = std::max<uint64_t>(1, std::min<uint64_t>(cfg.capacity, ops.size()) * entry_bytes_);
+        pass.maxCheckpoints = static_cast<size_t>(std::min<uint64_t>(kMaxCheckpoints, checkpoint_budget_ / full));
+    }
+    pass.interval = std::max(kMinInterval, ops.size() / std::max<size_t>(pass.maxCheckpoints, 1) + 1);
+    pass_ = std::move(pass);
+    prefix_hashes_ = std::move(hashes);
+    return resumed_from_;
+}
+
+void IncrementalSimulator::advance(size_t end) {
+    Pass& pass = *pass_;
+    end = std::min(end, pass.ops->size());
+    // Replay in checkpoint-sized segments
+    while (pass.at < end) {
+        size_t boundary = (pass.at / pass.interval + 1) * pass.interval;
+        size_t next = std::min(end, boundary);
+        Simulator::replay(*pass.ops, pass.at, next, *pass.policy, cfg_, pass.state, pass.result);
+        pass.at = next;
+        if (next == boundary || next == pass.ops->size()) {
+            addCheckpoint(next, (*prefix_hashes_)[next], *pass.policy, pass.state, pass.result);
+        }
+    }
+}
+
+SimResult IncrementalSimulator::finish() {
+    Pass& pass = *pass_;
+    Simulator::finish(*pass.policy, pass.state, pass.result);
+    last_ = std::move(pass.result);
+    pass_.reset();
+    return last_;
+}
+
+void IncrementalSimulator::addCheckpoint(size_t index, uint64_t prefixHash, const IPolicy& policy,
+                                         const ReplayState& state, const SimResult& result) {
+    size_t maxCount = pass_->maxCheckpoints;
+    if (maxCount == 0) {
+        return; // not even one fits the budget
+    }
+    uint64_t bytes = std::min<uint64_t>(cfg_.capacity, index) * entry_bytes_ +
+                     state.ledger.sizes.size() * (entry_bytes_ / 2);
+    checkpoints_.push_back(Checkpoint{index, prefixHash, policy.clone(), state,
+                                      (cfg_.animate ? result.steps : result.snapshots).size(), bytes});
+    thinCheckpoints(maxCount);
+}
+
+void IncrementalSimulator::thinCheckpoints(size_t maxCount) {
+    auto over = [&] {
+        return checkpoints_.size() > maxCount || (checkpoint_budget_ > 0 && checkpointBytes() > checkpoint_budget_);
+    };
+    while (!checkpoints_.empty() && over()) {
+        if (checkpoints_.size() == 1) {
+            checkpoints_.clear();
+            break;
+        }
+        // Thin out older checkpoints, always keeping the newest
+        std::vector<Checkpoint> kept;
+        kept.reserve(checkpoints_.size() / 2 + 1);
+        for (size_t i = checkpoints_.size() % 2 == 0 ? 1 : 0; i < checkpoints_.size(); i += 2) {
+            kept.push_back(std::move(checkpoints_[i]));
+        }
+        checkpoints_ = std::move(kept);
+    }
+}
+
+} // namespace cachesim
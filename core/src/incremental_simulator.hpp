@@ -0,0 +1,96 @@
+#pragma once
+
+#include "simulator.hpp"
+#include <memory>
+#include <optional>
+#include <vector>
+
+namespace cachesim {
+
+// Re-simulates a trace that changes between calls (e.g. edited in the UI)
+// for one policy and config. During a run it keeps periodic checkpoints of
+// the policy (via IPolicy::clone) and replay state, each tagged with a
+// rolling hash of the trace prefix it covers. The next run finds the longest
+// prefix shared with the previous trace, restores the last checkpoint inside
+// it and only replays the rest, so an edit near the end is cheap.
+// Results are identical to a fresh Simulator::run.
+//
+// With a checkpoint budget, checkpoints are spaced (and thinned) so their
+// estimated heap bytes stay within it; a cache too large for even one
+// checkpoint is re-simulated from scratch.
+class IncrementalSimulator {
+public:
+    IncrementalSimulator(std::unique_ptr<IPolicy> initial, const SimConfig& cfg, uint64_t checkpointBudget = 0);
+
+    // `hashes` are prefixHashes(ops), which sessions of other policies can
+    // share; computed here if null
+    SimResult run(const std::vector<TraceOp>& ops, std::shared_ptr<const std::vector<uint64_t>> hashes = nullptr);
+
+    // [i] = hash of ops [0, i)
+    static std::vector<uint64_t> prefixHashes(const std::vector<TraceOp>& ops);
+
+    // Applies to later runs; keeps the checkpoints that lead to the same
+    // recording under the new budget
+    void setStepBudget(uint64_t budget);
+
+    // 0 = unlimited; thins the kept checkpoints at once if they no longer fit
+    void setCheckpointBudget(uint64_t budget);
+
+    // Estimated heap bytes kept between runs: checkpoints plus the last
+    // result's recorded steps
+    uint64_t retainedBytes() const;
+
+    const SimConfig& config() const { return cfg_; }
+
+    // Op index the last run resumed from (0 = simulated from scratch)
+    size_t resumedFrom() const { return resumed_from_; }
+
+private:
+    static constexpr size_t kMaxCheckpoints = 64;
+    static constexpr size_t kMinInterval = 256;
+
+    struct Checkpoint {
+        size_t index;        // ops [0, index) applied
+        uint64_t prefixHash; // hash of ops [0, index)
+        std::unique_ptr<IPolicy> policy;
+        ReplayState state;
+        size_t steps;        // steps (or snapshots) recorded so far
+        uint64_t bytes;      // estimated heap footprint
+    };
+
+    // A run between start() and finish()
+    struct Pass {
+        const std::vector<TraceOp>* ops;
+        std::unique_ptr<IPolicy> policy;
+        ReplayState state;
+        SimResult result;
+        size_t at;       // ops [0, at) applied
+        size_t interval; // ops between checkpoints
+        size_t maxCheckpoints;
+    };
+
+    std::unique_ptr<IPolicy> initial_;
+    SimConfig cfg_;
+    uint64_t checkpoint_budget_;
+    uint64_t entry_bytes_ = kPolicyEntryBytes; // per cached entry, keys and values included
+    std::shared_ptr<const std::vector<uint64_t>> prefix_hashes_; // of the last trace
+    std::vector<Checkpoint> checkpoints_; // ascending index
+    SimResult last_;
+    size_t resumed_from_ = 0;
+    std::optional<Pass> pass_;
+
+    // run() in steps: start() restores the checkpoint to resume from and
+    // returns its op index, advance() replays up to op `end`, finish()
+    // returns the result
+    size_t start(const std::vector<TraceOp>& ops, std::shared_ptr<const std::vector<uint64_t>> hashes);
+    void advance(size_t end);
+    SimResult finish();
+    void addCheckpoint(size_t index, uint64_t prefixHash, const IPolicy& policy,
+                       const ReplayState& state, const SimResult& result);
+    uint64_t checkpointBytes() const;
+    // Halves the checkpoints (keeping the newest) until at most `maxCount`
+    // remain and they fit the budget
+    void thinCheckpoints(size_t maxCount);
+};
+
+} // namespace cachesim
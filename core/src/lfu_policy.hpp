@@ -21,6 +21,24 @@ private:
     int min_frequency_;
     std::unordered_map<std::string, std::list<Node>::iterator> key_map_;
     std::unordered_map<int, std::list<Node>> frequency_lists_;
+    uint64_t hit_path_writes_ = 0;
+
+    void reindex() {
+        for (auto& [freq, list] : frequency_lists_) {
+            for (auto it = list.begin(); it != list.end(); ++it) {
+                key_map_[it->key] = it;
+            }
+        }
+    }
+
+    // Advance to the next-lowest frequency still in use
+    void advanceMinFrequency() {
+        min_frequency_ = 1;
+        if (!frequency_lists_.empty()) {
+            min_frequency_ = std::min_element(frequency_lists_.begin(), frequency_lists_.end(),
+                [](const auto& a, const auto& b) { return a.first < b.first; })->first;
+        }
+    }
 
 public:
     explicit LFUPolicy(size_t capacity) : capacity_(capacity), min_frequency_(1) {}
@@ -49,6 +67,7 @@ public:
         int new_freq = old_freq + 1;
         frequency_lists_[new_freq].emplace_front(key, outVal, new_freq);
         key_map_[key] = frequency_lists_[new_freq].begin();
+        ++hit_path_writes_;
         
         return true; // hit
     }
@@ -78,16 +97,7 @@ public:
         } else {
             // New key
             if (key_map_.size() >= capacity_) {
-                // Evict one key from min_frequency_ list (LRU within same freq)
-                auto& min_freq_list = frequency_lists_[min_frequency_];
-                auto lru_node = min_freq_list.back();
-                evicted = lru_node.key;
-                key_map_.erase(evicted.value());
-                min_freq_list.pop_back();
-                
-                if (min_freq_list.empty()) {
-                    frequency_lists_.erase(min_frequency_);
-                }
+                evicted = evict();
             }
             
             // Insert new key with frequency 1
@@ -99,6 +109,42 @@ public:
         return evicted;
     }
     
+    std::optional<std::string> evict() override {
+        if (key_map_.empty()) {
+            return std::nullopt;
+        }
+        
+        // Evict one key from min_frequency_ list (LRU within same freq)
+        auto& min_freq_list = frequency_lists_[min_frequency_];
+        std::string key = std::move(min_freq_list.back().key);
+        key_map_.erase(key);
+        min_freq_list.pop_back();
+        
+        if (min_freq_list.empty()) {
+            frequency_lists_.erase(min_frequency_);
+            advanceMinFrequency();
+        }
+        return key;
+    }
+    
+    bool erase(const std::string& key) override {
+        auto it = key_map_.find(key);
+        if (it == key_map_.end()) {
+            return false;
+        }
+        int freq = it->second->frequency;
+        auto& freq_list = frequency_lists_[freq];
+        freq_list.erase(it->second);
+        key_map_.erase(it);
+        if (freq_list.empty()) {
+            frequency_lists_.erase(freq);
+            if (freq == min_frequency_) {
+                advanceMinFrequency();
+            }
+        }
+        return true;
+    }
+    
     std::vector<std::pair<std::string, std::string>> snapshot() const override {
         std::vector<std::pair<std::string, std::string>> result;
         result.reserve(key_map_.size());
@@ -130,6 +176,28 @@ public:
     bool isCacheHit(const std::string& key) const override {
         return key_map_.find(key) != key_map_.end();
     }
+
+    uint64_t hitPathWrites() const override { return hit_path_writes_; }
+
+    std::unique_ptr<IPolicy> clone() const override {
+        // The implicit copy still points into our lists; re-point it at its own
+        auto copy = std::make_unique<LFUPolicy>(*this);
+        copy->reindex();
+        return copy;
+    }
+    
+    int keyFrequency(const std::string& key) const override {
+        auto it = key_map_.find(key);
+        return it == key_map_.end() ? 0 : it->second->frequency;
+    }
+    
+    PolicyGauges gauges() const override {
+        PolicyGauges g;
+        if (!key_map_.empty()) {
+            g.lfuMinFrequency = min_frequency_;
+        }
+        return g;
+    }
 };
 
 } // namespace cachesim
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../include/types.hpp"
+#include "prefetch.hpp"
 #include <list>
 #include <unordered_map>
 
@@ -17,6 +18,13 @@ private:
     size_t capacity_;
     std::list<Node> recency_list_; // MRU -> ... -> LRU
     std::unordered_map<std::string, std::list<Node>::iterator> key_map_;
+    uint64_t hit_path_writes_ = 0;
+
+    void reindex() {
+        for (auto it = recency_list_.begin(); it != recency_list_.end(); ++it) {
+            key_map_[it->key] = it;
+        }
+    }
 
 public:
     explicit LRUPolicy(size_t capacity) : capacity_(capacity) {}
@@ -32,7 +40,10 @@ public:
         outVal = node_it->value;
         
         // Move to front
-        recency_list_.splice(recency_list_.begin(), recency_list_, node_it);
+        if (node_it != recency_list_.begin()) {
+            recency_list_.splice(recency_list_.begin(), recency_list_, node_it);
+            ++hit_path_writes_;
+        }
         
         return true; // hit
     }
@@ -49,11 +60,7 @@ public:
         } else {
             // New key
             if (recency_list_.size() >= capacity_) {
-                // Evict LRU (back of list)
-                auto lru_node = recency_list_.back();
-                evicted = lru_node.key;
-                key_map_.erase(lru_node.key);
-                recency_list_.pop_back();
+                evicted = evict();
             }
             
             // Insert new node at front
@@ -64,6 +71,28 @@ public:
         return evicted;
     }
     
+    std::optional<std::string> evict() override {
+        if (recency_list_.empty()) {
+            return std::nullopt;
+        }
+        
+        // Evict LRU (back of list)
+        std::string key = std::move(recency_list_.back().key);
+        key_map_.erase(key);
+        recency_list_.pop_back();
+        return key;
+    }
+    
+    bool erase(const std::string& key) override {
+        auto it = key_map_.find(key);
+        if (it == key_map_.end()) {
+            return false;
+        }
+        recency_list_.erase(it->second);
+        key_map_.erase(it);
+        return true;
+    }
+    
     std::vector<std::pair<std::string, std::string>> snapshot() const override {
         std::vector<std::pair<std::string, std::string>> result;
         result.reserve(recency_list_.size());
@@ -78,6 +107,20 @@ public:
     bool isCacheHit(const std::string& key) const override {
         return key_map_.find(key) != key_map_.end();
     }
+
+    uint64_t hitPathWrites() const override { return hit_path_writes_; }
+
+    void prefetch(const TraceOp* first, const TraceOp* last) const override {
+        // Map nodes, then the list nodes a hit relinks
+        prefetchProbes(key_map_, first, last, [](const auto& entry) { prefetchLine(&*entry.second); });
+    }
+
+    std::unique_ptr<IPolicy> clone() const override {
+        // The implicit copy still points into our lists; re-point it at its own
+        auto copy = std::make_unique<LRUPolicy>(*this);
+        copy->reindex();
+        return copy;
+    }
 };
 
 } // namespace cachesim
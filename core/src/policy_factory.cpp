@@ -0,0 +1,36 @@
+#include "policy_factory.hpp"
+#include "lru_policy.hpp"
+#include "fifo_policy.hpp"
+#include "s3fifo_policy.hpp"
+#include "sieve_policy.hpp"
+#include "lfu_policy.hpp"
+#include "arc_policy.hpp"
+#include "wtinylfu_policy.hpp"
+#include "gdsf_policy.hpp"
+#include <stdexcept>
+
+namespace cachesim {
+
+std::unique_ptr<IPolicy> createPolicy(const std::string& policyName, size_t capacity) {
+    if (policyName == "LRU") {
+        return std::make_unique<LRUPolicy>(capacity);
+    } else if (policyName == "FIFO") {
+        return std::make_unique<FIFOPolicy>(capacity);
+    } else if (policyName == "S3-FIFO") {
+        return std::make_unique<S3FIFOPolicy>(capacity);
+    } else if (policyName == "SIEVE") {
+        return std::make_unique<SIEVEPolicy>(capacity);
+    } else if (policyName == "LFU") {
+        return std::make_unique<LFUPolicy>(capacity);
+    } else if (policyName == "ARC") {
+        return std::make_unique<ARCPolicy>(capacity);
+    } else if (policyName == "W-TinyLFU") {
+        return std::make_unique<WTinyLFUPolicy>(capacity);
+    } else if (policyName == "GDSF") {
+        return std::make_unique<GDSFPolicy>(capacity);
+    } else {
+        throw std::runtime_error("Unknown policy: " + policyName);
+    }
+}
+
+} // namespace cachesim
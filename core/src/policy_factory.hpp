@@ -0,0 +1,13 @@
+#pragma once
+
+#include "../include/types.hpp"
+#include <memory>
+#include <string>
+
+namespace cachesim {
+
+// Builds a policy by its display name ("LRU", "ARC", "W-TinyLFU", ...);
+// throws std::runtime_error for unknown names
+std::unique_ptr<IPolicy> createPolicy(const std::string& policyName, size_t capacity);
+
+} // namespace cachesim
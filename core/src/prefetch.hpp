@@ -0,0 +1,55 @@
+#pragma once
+
+#include "../include/types.hpp"
+#include <algorithm>
+
+namespace cachesim {
+
+// Software prefetch hint; a no-op where the compiler has no builtin
+inline void prefetchLine(const void* address) {
+#if defined(__GNUC__) || defined(__clang__)
+    __builtin_prefetch(address);
+#else
+    (void)address;
+#endif
+}
+
+// Keys handled per stage of prefetchProbes (bounds its stack buffer)
+constexpr size_t kPrefetchGroup = 64;
+
+// Group prefetching of the hash probes for the keys of ops [first, last):
+// hash every key, then touch each key's bucket and prefetch its first node,
+// then walk each bucket (warm by now) to the key's node and pass it to
+// `onNode`, which prefetches what the entry points at. The loads of one stage
+// are independent across keys, so their cache misses overlap instead of
+// being taken one op at a time. Only reads the map.
+template <typename Map, typename OnNode>
+inline void prefetchProbes(const Map& map, const TraceOp* first, const TraceOp* last, OnNode onNode) {
+    if (map.empty()) {
+        return;
+    }
+    size_t buckets[kPrefetchGroup];
+    while (first < last) {
+        size_t n = std::min<size_t>(kPrefetchGroup, static_cast<size_t>(last - first));
+        for (size_t i = 0; i < n; ++i) {
+            buckets[i] = map.bucket(first[i].key);
+        }
+        for (size_t i = 0; i < n; ++i) {
+            auto it = map.begin(buckets[i]);
+            if (it != map.end(buckets[i])) {
+                prefetchLine(&*it);
+            }
+        }
+        for (size_t i = 0; i < n; ++i) {
+            for (auto it = map.begin(buckets[i]); it != map.end(buckets[i]); ++it) {
+                if (it->first == first[i].key) {
+                    onNode(*it);
+                    break;
+                }
+            }
+        }
+        first += n;
+    }
+}
+
+} // namespace cachesim
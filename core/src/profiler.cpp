@@ -0,0 +1,64 @@
+#include "profiler.hpp"
+#include <algorithm>
+
+#if defined(__EMSCRIPTEN__) || defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace cachesim {
+
+Profiler::Profiler() : origin_(std::chrono::steady_clock::now()) {
+    spans_.reserve(16);
+    sampleHeap(heapBytes());
+}
+
+size_t Profiler::begin(std::string name, std::string detail) {
+    sampleHeap(heapBytes());
+    spans_.push_back(ProfileSpan{std::move(name), std::move(detail), elapsedUs(), 0, 0});
+    return spans_.size() - 1;
+}
+
+void Profiler::end(size_t index) {
+    ProfileSpan& span = spans_[index];
+    span.durationUs = elapsedUs() - span.startUs;
+    span.heapBytes = heapBytes();
+    sampleHeap(span.heapBytes);
+}
+
+std::vector<PhaseTotal> Profiler::totals() const {
+    std::vector<PhaseTotal> totals;
+    for (const auto& span : spans_) {
+        auto it = std::find_if(totals.begin(), totals.end(), [&](const PhaseTotal& total) {
+            return total.name == span.name && total.detail == span.detail;
+        });
+        if (it == totals.end()) {
+            totals.push_back(PhaseTotal{span.name, span.detail, span.durationUs, 1});
+        } else {
+            it->us += span.durationUs;
+            ++it->count;
+        }
+    }
+    return totals;
+}
+
+uint64_t Profiler::elapsedUs() const {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - origin_).count());
+}
+
+uint64_t Profiler::heapBytes() {
+#if defined(__EMSCRIPTEN__)
+    return static_cast<uint64_t>(mallinfo().uordblks);
+#elif defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+    struct mallinfo2 info = mallinfo2();
+    return static_cast<uint64_t>(info.uordblks + info.hblkhd); // arena + mmapped chunks
+#else
+    return 0;
+#endif
+}
+
+void Profiler::sampleHeap(uint64_t bytes) {
+    peak_heap_ = std::max(peak_heap_, bytes);
+}
+
+} // namespace cachesim
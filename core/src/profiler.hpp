@@ -0,0 +1,66 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace cachesim {
+
+struct ProfileSpan {
+    std::string name;   // phase, e.g. "parse" or "simulate"
+    std::string detail; // e.g. the policy name; empty if none
+    uint64_t startUs;   // since the profiler was created
+    uint64_t durationUs;
+    uint64_t heapBytes; // allocated bytes when the span ended (0 = unknown)
+};
+
+// Total time per phase (name + detail), in first-seen order
+struct PhaseTotal {
+    std::string name;
+    std::string detail;
+    uint64_t us;
+    size_t count;
+};
+
+// Lightweight phase timer for one request: monotonic-clock spans plus the
+// peak heap usage seen at span boundaries. Spans are recorded only at phase
+// granularity (a handful per request), so it is always on.
+class Profiler {
+public:
+    // Records the enclosing block as a span
+    class Scope {
+    public:
+        Scope(Profiler& profiler, std::string name, std::string detail = "")
+            : profiler_(profiler), index_(profiler.begin(std::move(name), std::move(detail))) {}
+        ~Scope() { profiler_.end(index_); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+    private:
+        Profiler& profiler_;
+        size_t index_;
+    };
+
+    Profiler();
+
+    size_t begin(std::string name, std::string detail = "");
+    void end(size_t index);
+
+    const std::vector<ProfileSpan>& spans() const { return spans_; }
+    std::vector<PhaseTotal> totals() const;
+    uint64_t elapsedUs() const;
+    uint64_t peakHeapBytes() const { return peak_heap_; }
+
+    // Bytes currently allocated by malloc, or 0 where that is not available
+    static uint64_t heapBytes();
+
+private:
+    std::chrono::steady_clock::time_point origin_;
+    std::vector<ProfileSpan> spans_;
+    uint64_t peak_heap_ = 0;
+
+    void sampleHeap(uint64_t bytes);
+};
+
+} // namespace cachesim
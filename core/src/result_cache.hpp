@@ -0,0 +1,58 @@
+#pragma once
+
+#include "lru_policy.hpp"
+#include <limits>
+#include <unordered_map>
+
+namespace cachesim {
+
+// Content-addressed store of serialized results, bounded by total bytes.
+// Payloads live in our own LRUPolicy, which also decides what to drop:
+// entries are evicted least-recently-used first until a new one fits.
+class ResultCache {
+public:
+    explicit ResultCache(size_t maxBytes)
+        : max_bytes_(maxBytes), lru_(std::numeric_limits<size_t>::max()) {}
+
+    bool lookup(const std::string& key, std::string& out) {
+        return lru_.get(key, out);
+    }
+
+    void store(const std::string& key, const std::string& value) {
+        size_t size = key.size() + value.size();
+        if (size > max_bytes_ || lru_.isCacheHit(key)) {
+            return; // too large to keep, or already cached (same key = same content)
+        }
+        while (used_bytes_ + size > max_bytes_) {
+            auto victim = lru_.evict();
+            if (!victim) break;
+            auto it = sizes_.find(*victim);
+            used_bytes_ -= it->second;
+            sizes_.erase(it);
+        }
+        lru_.put(key, value);
+        sizes_[key] = size;
+        used_bytes_ += size;
+    }
+
+    size_t usedBytes() const { return used_bytes_; }
+    size_t entries() const { return sizes_.size(); }
+
+    // 64-bit FNV-1a, used to address results by trace content
+    static uint64_t hashText(const std::string& text) {
+        uint64_t h = 0xcbf29ce484222325ULL;
+        for (unsigned char c : text) {
+            h ^= c;
+            h *= 0x100000001b3ULL;
+        }
+        return h;
+    }
+
+private:
+    size_t max_bytes_;
+    size_t used_bytes_ = 0;
+    LRUPolicy lru_;
+    std::unordered_map<std::string, size_t> sizes_;
+};
+
+} // namespace cachesim
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace cachesim {
+
+// Contiguous FIFO queue backed by a power-of-two circular array.
+// Index 0 is the oldest element (front), size()-1 the newest (back).
+template <typename T>
+class RingBuffer {
+private:
+    std::vector<T> slots_;
+    size_t head_ = 0; // physical index of front
+    size_t size_ = 0;
+
+    size_t physical(size_t i) const { return (head_ + i) & (slots_.size() - 1); }
+
+    void grow() {
+        std::vector<T> bigger(slots_.empty() ? 8 : slots_.size() * 2);
+        for (size_t i = 0; i < size_; ++i) {
+            bigger[i] = std::move(slots_[physical(i)]);
+        }
+        slots_.swap(bigger);
+        head_ = 0;
+    }
+
+public:
+    RingBuffer() = default;
+    explicit RingBuffer(size_t expected) {
+        size_t cap = 8;
+        while (cap < expected) cap <<= 1;
+        slots_.resize(cap);
+    }
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    T& operator[](size_t i) { return slots_[physical(i)]; }
+    const T& operator[](size_t i) const { return slots_[physical(i)]; }
+
+    T& front() { return slots_[head_]; }
+    const T& front() const { return slots_[head_]; }
+    T& back() { return slots_[physical(size_ - 1)]; }
+    const T& back() const { return slots_[physical(size_ - 1)]; }
+
+    void push_back(T value) {
+        if (size_ == slots_.size()) grow();
+        slots_[physical(size_)] = std::move(value);
+        ++size_;
+    }
+
+    T pop_front() {
+        T value = std::move(slots_[head_]);
+        head_ = physical(1);
+        --size_;
+        return value;
+    }
+
+    void clear() {
+        head_ = 0;
+        size_ = 0;
+    }
+};
+
+} // namespace cachesim
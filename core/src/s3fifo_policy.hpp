@@ -0,0 +1,246 @@
+#pragma once
+
+#include "../include/types.hpp"
+#include "ring_buffer.hpp"
+#include <algorithm>
+#include <unordered_map>
+
+namespace cachesim {
+
+// S3-FIFO: three FIFO queues. New keys enter a small queue (10% of
+// capacity); keys accessed again while there move to the main queue,
+// others are dropped and remembered in a ghost queue. Keys found in the
+// ghost queue skip the small queue. The main queue is a FIFO with
+// reinsertion: a 2-bit frequency counter buys an entry another lap.
+// A hit only bumps the counter, and only while it is below 3.
+class S3FIFOPolicy : public IPolicy {
+private:
+    struct Entry {
+        std::string value;
+        uint8_t freq;
+        uint64_t seq; // tag of its queue slot
+        bool inMain;
+    };
+
+    // Queue slot; it is stale once the key's entry (or live ghost) has
+    // another seq, e.g. after erase() and re-insertion. Stale slots do not
+    // count toward the small queue's share and are compacted away once they
+    // outnumber live entries.
+    struct Slot {
+        std::string key;
+        uint64_t seq;
+    };
+
+    size_t capacity_;
+    size_t small_capacity_;
+    size_t ghost_capacity_;
+
+    RingBuffer<Slot> small_; // oldest -> newest
+    RingBuffer<Slot> main_;  // oldest -> newest
+    RingBuffer<Slot> ghost_; // oldest -> newest (keys only)
+    std::unordered_map<std::string, Entry> entries_;
+    std::unordered_map<std::string, uint64_t> ghost_index_; // key -> seq of its live ghost slot
+    uint64_t seq_ = 0;
+    uint64_t ghost_seq_ = 0;
+    size_t small_stale_ = 0;
+    size_t main_stale_ = 0;
+    uint64_t hit_path_writes_ = 0;
+
+    void insertGhost(const std::string& key) {
+        if (ghost_capacity_ == 0) return;
+        if (ghost_.size() >= ghost_capacity_) {
+            Slot old = ghost_.pop_front();
+            auto it = ghost_index_.find(old.key);
+            if (it != ghost_index_.end() && it->second == old.seq) {
+                ghost_index_.erase(it);
+            }
+        }
+        ghost_index_[key] = ghost_seq_;
+        ghost_.push_back(Slot{key, ghost_seq_++});
+    }
+
+    // Entry of a live queue slot, or null if the slot is stale
+    Entry* entryFor(const Slot& slot) {
+        auto it = entries_.find(slot.key);
+        return it != entries_.end() && it->second.seq == slot.seq ? &it->second : nullptr;
+    }
+
+    const Entry* entryFor(const Slot& slot) const {
+        auto it = entries_.find(slot.key);
+        return it != entries_.end() && it->second.seq == slot.seq ? &it->second : nullptr;
+    }
+
+    void compact(RingBuffer<Slot>& queue) {
+        RingBuffer<Slot> live(queue.size());
+        while (!queue.empty()) {
+            Slot slot = queue.pop_front();
+            if (entryFor(slot)) live.push_back(std::move(slot));
+        }
+        queue = std::move(live);
+    }
+
+    void compact() {
+        compact(small_);
+        compact(main_);
+        small_stale_ = 0;
+        main_stale_ = 0;
+    }
+
+    // Returns true and sets `evicted` if a key left the cache
+    bool evictSmall(std::string& evicted) {
+        Slot slot = small_.pop_front();
+        Entry* entry = entryFor(slot);
+        if (!entry) {
+            --small_stale_; // erased
+            return false;
+        }
+        if (entry->freq > 0) {
+            // Accessed again while probationary - promote
+            entry->freq = 0;
+            entry->inMain = true;
+            main_.push_back(std::move(slot));
+            return false;
+        }
+        insertGhost(slot.key);
+        entries_.erase(slot.key);
+        evicted = std::move(slot.key);
+        return true;
+    }
+
+    bool evictMain(std::string& evicted) {
+        Slot slot = main_.pop_front();
+        Entry* entry = entryFor(slot);
+        if (!entry) {
+            --main_stale_; // erased
+            return false;
+        }
+        if (entry->freq > 0) {
+            // Reinsert with one less credit
+            entry->freq--;
+            main_.push_back(std::move(slot));
+            return false;
+        }
+        entries_.erase(slot.key);
+        evicted = std::move(slot.key);
+        return true;
+    }
+
+    std::string evictOne() {
+        std::string evicted;
+        for (;;) {
+            bool done = (small_.size() - small_stale_ >= small_capacity_ || main_.size() == main_stale_)
+                ? evictSmall(evicted)
+                : evictMain(evicted);
+            if (done) return evicted;
+        }
+    }
+
+public:
+    explicit S3FIFOPolicy(size_t capacity)
+        : capacity_(capacity),
+          small_capacity_(std::max<size_t>(1, capacity / 10)),
+          ghost_capacity_(capacity > small_capacity_ ? capacity - small_capacity_ : capacity),
+          small_(small_capacity_),
+          main_(capacity),
+          ghost_(ghost_capacity_) {
+        entries_.reserve(capacity);
+    }
+
+    bool get(const std::string& key, std::string& outVal) override {
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            return false; // miss (ghost entries hold no value)
+        }
+
+        // Hit - bump the saturating counter, no queue movement
+        Entry& entry = it->second;
+        if (entry.freq < 3) {
+            entry.freq++;
+            ++hit_path_writes_;
+        }
+        outVal = entry.value;
+        return true; // hit
+    }
+
+    std::optional<std::string> put(const std::string& key, const std::string& val) override {
+        auto it = entries_.find(key);
+        if (it != entries_.end()) {
+            // Key exists - update value and treat as access
+            it->second.value = val;
+            it->second.freq = std::min<uint8_t>(it->second.freq + 1, 3);
+            return std::nullopt;
+        }
+
+        std::optional<std::string> evicted;
+        if (entries_.size() >= capacity_) {
+            evicted = evictOne();
+        }
+
+        auto ghost_it = ghost_index_.find(key);
+        if (ghost_it != ghost_index_.end()) {
+            // Recently evicted from small - go straight to main
+            ghost_index_.erase(ghost_it);
+            entries_[key] = Entry{val, 0, seq_, true};
+            main_.push_back(Slot{key, seq_++});
+        } else {
+            entries_[key] = Entry{val, 0, seq_, false};
+            small_.push_back(Slot{key, seq_++});
+        }
+
+        return evicted;
+    }
+
+    std::optional<std::string> evict() override {
+        if (entries_.empty()) return std::nullopt;
+        return evictOne();
+    }
+
+    bool erase(const std::string& key) override {
+        // Its queue slot goes stale and is skipped when it reaches the front
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            return false;
+        }
+        ++(it->second.inMain ? main_stale_ : small_stale_);
+        entries_.erase(it);
+        if (small_stale_ + main_stale_ > entries_.size() + 8) {
+            compact();
+        }
+        return true;
+    }
+
+    std::vector<std::pair<std::string, std::string>> snapshot() const override {
+        std::vector<std::pair<std::string, std::string>> result;
+        result.reserve(entries_.size());
+
+        // Main (newest first), then small (newest first)
+        for (const auto* queue : {&main_, &small_}) {
+            for (size_t i = queue->size(); i-- > 0;) {
+                const Slot& slot = (*queue)[i];
+                if (const Entry* entry = entryFor(slot)) {
+                    result.emplace_back(slot.key, entry->value);
+                }
+            }
+        }
+
+        return result;
+    }
+
+    void metaForUI(Step& s) const override {
+        for (const auto& [key, entry] : entries_) {
+            s.freq[key] = entry.freq;
+        }
+    }
+
+    bool isCacheHit(const std::string& key) const override {
+        return entries_.find(key) != entries_.end();
+    }
+
+    uint64_t hitPathWrites() const override { return hit_path_writes_; }
+
+    std::unique_ptr<IPolicy> clone() const override {
+        return std::make_unique<S3FIFOPolicy>(*this);
+    }
+};
+
+} // namespace cachesim
@@ -0,0 +1,131 @@
+#include "sharded_simulator.hpp"
+#include "simulator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+namespace cachesim {
+
+namespace {
+
+// Threads are unavailable in a wasm build without -pthread
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+constexpr bool kHaveThreads = false;
+#else
+constexpr bool kHaveThreads = true;
+#endif
+
+void replayShard(const std::vector<const TraceOp*>& stream, IPolicy& policy, ShardStats& out,
+                 ByteLedger* bytes) {
+    std::optional<std::string> evicted;
+    TimingWheel expiry;
+    for (const TraceOp* op : stream) {
+        evicted.reset();
+        Simulator::applyOp(*op, policy, out.stats, evicted, bytes, &expiry);
+    }
+    out.ops = stream.size();
+    out.stats.hitPathWrites = policy.hitPathWrites();
+}
+
+} // namespace
+
+size_t ShardedSimulator::shardOf(const std::string& key, size_t shardCount) {
+    // Fibonacci hashing on top of std::hash so low-entropy hashes still spread
+    uint64_t h = std::hash<std::string>{}(key);
+    h *= 0x9E3779B97F4A7C15ULL;
+    return static_cast<size_t>((h >> 32) % shardCount);
+}
+
+ShardedResult ShardedSimulator::run(const std::vector<TraceOp>& ops, const PolicyFactory& factory,
+                                    size_t capacity, size_t shardCount,
+                                    uint64_t byteCapacity, bool trackBytes) {
+    if (shardCount == 0) {
+        throw std::runtime_error("Shard count must be greater than 0");
+    }
+    if (shardCount > capacity) {
+        throw std::runtime_error("Shard count must not exceed capacity");
+    }
+    if (byteCapacity > 0 && shardCount > byteCapacity) {
+        throw std::runtime_error("Shard count must not exceed byte capacity");
+    }
+
+    ShardedResult result;
+    result.shards.resize(shardCount);
+
+    // One pass: split the trace into per-shard streams
+    std::vector<std::vector<const TraceOp*>> streams(shardCount);
+    for (auto& stream : streams) {
+        stream.reserve(ops.size() / shardCount + 1);
+    }
+    for (const auto& op : ops) {
+        streams[shardOf(op.key, shardCount)].push_back(&op);
+    }
+
+    std::vector<std::unique_ptr<IPolicy>> policies;
+    std::vector<ByteLedger> ledgers(shardCount);
+    policies.reserve(shardCount);
+    for (size_t i = 0; i < shardCount; ++i) {
+        size_t shardCapacity = capacity / shardCount + (i < capacity % shardCount ? 1 : 0);
+        result.shards[i].capacity = shardCapacity;
+        policies.push_back(factory(shardCapacity));
+        ledgers[i].capacity = byteCapacity / shardCount + (i < byteCapacity % shardCount ? 1 : 0);
+    }
+    bool bytes = byteCapacity > 0 || trackBytes;
+
+    size_t workers = 0;
+    if (kHaveThreads && shardCount > 1) {
+        workers = std::min<size_t>(shardCount, std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    if (workers <= 1) {
+        for (size_t i = 0; i < shardCount; ++i) {
+            replayShard(streams[i], *policies[i], result.shards[i], bytes ? &ledgers[i] : nullptr);
+        }
+    } else {
+        // Workers pull shards from a shared counter so uneven shards balance out
+        std::atomic<size_t> next{0};
+        std::exception_ptr failure;
+        std::atomic<bool> failed{false};
+        std::vector<std::thread> threads;
+        threads.reserve(workers);
+        for (size_t w = 0; w < workers; ++w) {
+            threads.emplace_back([&]() {
+                for (size_t i = next++; i < shardCount; i = next++) {
+                    try {
+                        replayShard(streams[i], *policies[i], result.shards[i],
+                                    bytes ? &ledgers[i] : nullptr);
+                    } catch (...) {
+                        if (!failed.exchange(true)) {
+                            failure = std::current_exception();
+                        }
+                        return;
+                    }
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+        if (failure) {
+            std::rethrow_exception(failure);
+        }
+    }
+
+    // Merge stats and compute imbalance
+    size_t maxOps = 0;
+    result.minShardHitRatio = 1.0;
+    for (const auto& shard : result.shards) {
+        result.stats.merge(shard.stats);
+        maxOps = std::max(maxOps, shard.ops);
+        result.minShardHitRatio = std::min(result.minShardHitRatio, shard.stats.hitRatio());
+        result.maxShardHitRatio = std::max(result.maxShardHitRatio, shard.stats.hitRatio());
+    }
+    double meanOps = double(ops.size()) / double(shardCount);
+    result.loadImbalance = meanOps > 0 ? double(maxOps) / meanOps : 0.0;
+
+    return result;
+}
+
+} // namespace cachesim
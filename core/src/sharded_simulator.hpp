@@ -0,0 +1,39 @@
+#pragma once
+
+#include "../include/types.hpp"
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace cachesim {
+
+using PolicyFactory = std::function<std::unique_ptr<IPolicy>(size_t capacity)>;
+
+struct ShardStats {
+    size_t capacity = 0;
+    size_t ops = 0;
+    Stats stats;
+};
+
+struct ShardedResult {
+    Stats stats;                     // merged over all shards
+    std::vector<ShardStats> shards;
+    double loadImbalance = 0.0;      // busiest shard ops / mean shard ops
+    double minShardHitRatio = 0.0;
+    double maxShardHitRatio = 0.0;
+};
+
+// Models a cache split into N hash-partitioned shards, each with its own
+// replacement state and an equal share of the capacity (and byte budget,
+// if any). The trace is partitioned in one pass and each shard is replayed
+// on its own thread.
+class ShardedSimulator {
+public:
+    ShardedResult run(const std::vector<TraceOp>& ops, const PolicyFactory& factory,
+                      size_t capacity, size_t shardCount,
+                      uint64_t byteCapacity = 0, bool trackBytes = false);
+
+    static size_t shardOf(const std::string& key, size_t shardCount);
+};
+
+} // namespace cachesim
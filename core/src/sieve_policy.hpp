@@ -0,0 +1,183 @@
+#pragma once
+
+#include "../include/types.hpp"
+#include "ring_buffer.hpp"
+#include <unordered_map>
+
+namespace cachesim {
+
+// SIEVE: FIFO insertion order plus a visited bit per entry. A hand sweeps
+// from the oldest entry toward the newest, clearing visited bits and
+// evicting the first unvisited entry it finds; survivors stay in place.
+// A hit only sets the visited bit, and only when it is not already set.
+//
+// Entries live in a ring buffer in insertion order. Evictions behind the
+// oldest entry just advance the ring; evictions in the middle leave a hole
+// that is compacted away once holes outnumber live entries.
+class SIEVEPolicy : public IPolicy {
+private:
+    struct Slot {
+        std::string key;
+        bool visited = false;
+        bool live = false;
+    };
+
+    struct Entry {
+        std::string value;
+        uint64_t seq; // absolute insertion sequence -> ring index = seq - base_seq_
+    };
+
+    size_t capacity_;
+    RingBuffer<Slot> slots_; // oldest -> newest
+    std::unordered_map<std::string, Entry> entries_;
+    uint64_t base_seq_ = 0;  // seq of slots_[0]
+    uint64_t hand_ = 0;      // seq the hand points at
+    uint64_t hit_path_writes_ = 0;
+
+    Slot& slotFor(uint64_t seq) { return slots_[static_cast<size_t>(seq - base_seq_)]; }
+    uint64_t endSeq() const { return base_seq_ + slots_.size(); }
+
+    void dropDeadFront() {
+        while (!slots_.empty() && !slots_.front().live) {
+            slots_.pop_front();
+            ++base_seq_;
+        }
+        if (hand_ < base_seq_) hand_ = base_seq_;
+    }
+
+    void compact() {
+        RingBuffer<Slot> live(entries_.size());
+        uint64_t new_hand = base_seq_;
+        for (uint64_t seq = base_seq_; seq < endSeq(); ++seq) {
+            Slot& slot = slotFor(seq);
+            if (!slot.live) continue;
+            if (seq < hand_) ++new_hand;
+            entries_.at(slot.key).seq = base_seq_ + live.size();
+            live.push_back(std::move(slot));
+        }
+        slots_ = std::move(live);
+        hand_ = new_hand;
+    }
+
+    std::string evictOne() {
+        for (;;) {
+            if (hand_ >= endSeq()) hand_ = base_seq_; // wrap to the oldest entry
+            Slot& slot = slotFor(hand_);
+            if (slot.live) {
+                if (!slot.visited) break;
+                slot.visited = false;
+            }
+            ++hand_;
+        }
+
+        Slot& victim = slotFor(hand_);
+        std::string key = std::move(victim.key);
+        victim.live = false;
+        entries_.erase(key);
+        ++hand_;
+
+        dropDeadFront();
+        if (slots_.size() > 2 * entries_.size() + 8) {
+            compact();
+        }
+        return key;
+    }
+
+public:
+    explicit SIEVEPolicy(size_t capacity) : capacity_(capacity), slots_(capacity) {
+        entries_.reserve(capacity);
+    }
+
+    bool get(const std::string& key, std::string& outVal) override {
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            return false; // miss
+        }
+
+        // Hit - set visited bit (skip the store if already set)
+        Slot& slot = slotFor(it->second.seq);
+        if (!slot.visited) {
+            slot.visited = true;
+            ++hit_path_writes_;
+        }
+        outVal = it->second.value;
+        return true; // hit
+    }
+
+    std::optional<std::string> put(const std::string& key, const std::string& val) override {
+        auto it = entries_.find(key);
+        if (it != entries_.end()) {
+            // Key exists - update value and mark visited
+            it->second.value = val;
+            slotFor(it->second.seq).visited = true;
+            return std::nullopt;
+        }
+
+        std::optional<std::string> evicted;
+        if (entries_.size() >= capacity_) {
+            evicted = evictOne();
+        }
+
+        // New keys go to the head (newest end)
+        entries_[key] = Entry{val, endSeq()};
+        slots_.push_back(Slot{key, false, true});
+
+        return evicted;
+    }
+
+    std::optional<std::string> evict() override {
+        if (entries_.empty()) return std::nullopt;
+        return evictOne();
+    }
+
+    bool erase(const std::string& key) override {
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            return false;
+        }
+        // Leaves a hole, like an eviction in the middle
+        slotFor(it->second.seq).live = false;
+        entries_.erase(it);
+        dropDeadFront();
+        if (slots_.size() > 2 * entries_.size() + 8) {
+            compact();
+        }
+        return true;
+    }
+
+    std::vector<std::pair<std::string, std::string>> snapshot() const override {
+        std::vector<std::pair<std::string, std::string>> result;
+        result.reserve(entries_.size());
+
+        // Newest first
+        for (size_t i = slots_.size(); i-- > 0;) {
+            const Slot& slot = slots_[i];
+            if (slot.live) {
+                result.emplace_back(slot.key, entries_.at(slot.key).value);
+            }
+        }
+
+        return result;
+    }
+
+    void metaForUI(Step& s) const override {
+        for (size_t i = 0; i < slots_.size(); ++i) {
+            const Slot& slot = slots_[i];
+            if (slot.live) {
+                s.freq[slot.key] = slot.visited ? 1 : 0;
+            }
+        }
+    }
+
+    bool isCacheHit(const std::string& key) const override {
+        return entries_.find(key) != entries_.end();
+    }
+
+    uint64_t hitPathWrites() const override { return hit_path_writes_; }
+
+    std::unique_ptr<IPolicy> clone() const override {
+        return std::make_unique<SIEVEPolicy>(*this);
+    }
+};
+
+} // namespace cachesim
@@ -5,76 +5,247 @@ namespace cachesim {
 
 SimResult Simulator::run(const std::vector<TraceOp>& ops, IPolicy& policy, const SimConfig& cfg) {
     SimResult result;
-    result.stats = Stats{};
-    
-    // Performance guardrail for animate mode
-    if (cfg.animate && ops.size() > 20000) {
-        // Auto-switch to fast mode for very large traces
-        SimConfig fast_cfg = cfg;
-        fast_cfg.animate = false;
-        return run(ops, policy, fast_cfg);
+    ReplayState state = initialState(cfg);
+    replay(ops, 0, ops.size(), policy, cfg, state, result);
+    finish(policy, state, result);
+    return result;
+}
+
+ReplayState Simulator::initialState(const SimConfig& cfg) {
+    ReplayState state;
+    state.ledger.capacity = cfg.byteCapacity;
+    state.recorder = StepRecorder(cfg.animate ? 1 : cfg.snapshotEvery, cfg.stepBudget);
+    if (cfg.metricsWindow > 0) {
+        state.series.emplace(cfg.metricsWindow, cfg.metricsAlpha);
     }
+    return state;
+}
+
+void Simulator::replay(const std::vector<TraceOp>& ops, size_t begin, size_t end, IPolicy& policy,
+                       const SimConfig& cfg, ReplayState& state, SimResult& result) {
+    ByteLedger* bytes = (cfg.byteCapacity > 0 || cfg.trackBytes) ? &state.ledger : nullptr;
     
-    for (size_t i = 0; i < ops.size(); ++i) {
+    for (size_t i = begin; i < end; ++i) {
+        if (cfg.prefetchBatch > 0 && (i - begin) % cfg.prefetchBatch == 0) {
+            policy.prefetch(&ops[i], &ops[0] + std::min(end, i + cfg.prefetchBatch));
+        }
         const auto& op = ops[i];
-        bool hit = false;
         std::optional<std::string> evicted;
+        bool hit = applyOp(op, policy, state.stats, evicted, bytes, &state.expiry);
         
-        if (op.kind == TraceOp::Kind::GET) {
-            std::string value;
-            
-            // For ARC policy, we need to check cache state BEFORE calling get()
-            bool wasInCache = policy.isCacheHit(op.key);
-            
-            hit = policy.get(op.key, value);
-            
-            // For ARC policy, we need to distinguish between cache hits and ghost hits
-            if (hit) {
-                if (wasInCache) {
-                    result.stats.hits++;
-                } else {
-                    result.stats.misses++; // Ghost hit counts as miss for statistics
-                }
-            } else {
-                result.stats.misses++;
+        if (state.series) {
+            state.series->onOp(state.stats, policy);
+        }
+        
+        // Steps in animate mode, sparse snapshots in fast mode, thinned to
+        // fit the step budget (the cache is only copied when kept)
+        bool finalOp = i == ops.size() - 1;
+        if (state.recorder.wants(i, finalOp)) {
+            state.recorder.add(createStep(i, op, hit, evicted, policy, state.stats),
+                               cfg.animate ? result.steps : result.snapshots, finalOp);
+        }
+    }
+}
+
+void Simulator::finish(const IPolicy& policy, ReplayState& state, SimResult& result) {
+    result.stats = state.stats;
+    if (state.series) {
+        state.series->finish(state.stats, policy);
+        result.series = state.series->take();
+    }
+    result.stats.hitPathWrites = policy.hitPathWrites();
+    result.fidelity = state.recorder.fidelity();
+}
+
+bool Simulator::applyOp(const TraceOp& op, IPolicy& policy, Stats& stats,
+                        std::optional<std::string>& evicted, ByteLedger* bytes,
+                        TimingWheel* expiry) {
+    bool hit = false;
+    
+    if (bytes && op.size == 0 && op.kind != TraceOp::Kind::DEL) {
+        bytes->sizedOps = false; // later ops may rely on remembered sizes
+    }
+    
+    if (expiry) {
+        // Expired entries leave before the op sees the cache
+        expiry->advance(op.timestamp, [&](const std::string& key) {
+            if (!policy.erase(key)) return;
+            stats.expirations++;
+            if (bytes) {
+                bytes->used -= bytes->sizes[key];
+                bytes->forget(key);
             }
-        } else { // PUT
-            evicted = policy.put(op.key, op.value);
-            if (evicted) {
-                result.stats.evictions++;
+        });
+    }
+    
+    if (op.kind == TraceOp::Kind::GET) {
+        std::string value;
+        
+        // For ARC policy, we need to check cache state BEFORE calling get()
+        bool wasInCache = policy.isCacheHit(op.key);
+        
+        hit = policy.get(op.key, value);
+        
+        // For ARC policy, we need to distinguish between cache hits and ghost hits
+        if (hit) {
+            if (wasInCache) {
+                stats.hits++;
+            } else {
+                stats.misses++; // Ghost hit counts as miss for statistics
+                stats.ghostHits++;
             }
-            // PUT operations don't count toward hit/miss ratio
-            hit = false; // PUT operations are never hits for statistics
+        } else {
+            stats.misses++;
         }
         
-        // Create step record
-        Step step = createStep(i, op, hit, evicted, policy);
+        if (bytes) {
+            auto known = bytes->sizes.find(op.key);
+            uint64_t size = op.size ? op.size : (known != bytes->sizes.end() ? known->second : 0);
+            if (hit && wasInCache) {
+                stats.bytesHit += known != bytes->sizes.end() ? known->second : size;
+            } else {
+                stats.bytesMissed += size;
+            }
+            
+            if (hit && !wasInCache) {
+                // Ghost hit re-admitted the key (ARC) - it now occupies bytes again
+                bytes->used += size;
+                bytes->sizes[op.key] = size;
+                while (bytes->capacity && bytes->used > bytes->capacity) {
+                    auto victim = policy.evict();
+                    if (!victim) break;
+                    chargeEviction(*victim, stats, evicted, *bytes, expiry);
+                }
+            }
+        }
         
-        if (cfg.animate) {
-            // Record every step in animate mode
-            result.steps.push_back(std::move(step));
-        } else {
-            // Record sparse snapshots in fast mode
-            if (i % cfg.snapshotEvery == 0 || i == ops.size() - 1) {
-                result.snapshots.push_back(std::move(step));
+        if (!hit && op.fill) {
+            // Demand fill: a miss brings the key in (value defaults to the key)
+            const std::string& value = op.value.empty() ? op.key : op.value;
+            uint64_t size = op.size;
+            if (!size && bytes) {
+                auto known = bytes->sizes.find(op.key);
+                size = known != bytes->sizes.end() ? known->second : value.size();
             }
+            store(op.key, value, size ? size : value.size(), policy, stats, evicted, bytes, expiry);
+            if (expiry) setExpiry(op, policy, *expiry);
         }
+    } else if (op.kind == TraceOp::Kind::DEL) {
+        // Not a hit, a miss or an eviction: the key just leaves
+        if (policy.erase(op.key)) {
+            if (bytes) {
+                bytes->used -= bytes->sizes[op.key];
+                bytes->forget(op.key);
+            }
+            if (expiry) expiry->cancel(op.key);
+        }
+    } else { // PUT
+        store(op.key, op.value, op.objectSize(), policy, stats, evicted, bytes, expiry);
+        if (expiry) setExpiry(op, policy, *expiry);
+        // PUT operations don't count toward hit/miss ratio
+        hit = false; // PUT operations are never hits for statistics
     }
     
-    return result;
+    return hit;
+}
+
+void Simulator::applyBatch(const TraceOp* first, const TraceOp* last, IPolicy& policy, Stats& stats,
+                           ByteLedger* bytes, size_t prefetchBatch, TimingWheel* expiry) {
+    std::optional<std::string> evicted;
+    size_t batch = prefetchBatch > 0 ? prefetchBatch : static_cast<size_t>(last - first);
+    while (first < last) {
+        const TraceOp* groupEnd = first + std::min<size_t>(batch, static_cast<size_t>(last - first));
+        if (prefetchBatch > 0) {
+            policy.prefetch(first, groupEnd);
+        }
+        for (; first < groupEnd; ++first) {
+            evicted.reset();
+            applyOp(*first, policy, stats, evicted, bytes, expiry);
+        }
+    }
+}
+
+void Simulator::store(const std::string& key, const std::string& value, uint64_t size,
+                      IPolicy& policy, Stats& stats, std::optional<std::string>& evicted,
+                      ByteLedger* bytes, TimingWheel* expiry) {
+    if (!bytes) {
+        evicted = policy.put(key, value);
+        if (evicted) {
+            stats.evictions++;
+            if (expiry) expiry->cancel(*evicted);
+        }
+        return;
+    }
+    
+    // With byte accounting
+    bool resident = policy.isCacheHit(key);
+    
+    if (bytes->capacity && size > bytes->capacity) {
+        // Larger than the whole cache - never admitted; an update to that
+        // size drops the old copy
+        if (resident && policy.erase(key)) {
+            chargeEviction(key, stats, evicted, *bytes, expiry);
+        }
+        if (!bytes->sizedOps) bytes->sizes[key] = size;
+        return;
+    }
+    
+    uint64_t oldSize = resident ? bytes->sizes[key] : 0;
+    
+    // Evict until the new object fits
+    while (bytes->capacity && bytes->used - oldSize + size > bytes->capacity) {
+        auto victim = policy.evict();
+        if (!victim) break;
+        if (*victim == key) {
+            oldSize = 0; // the updated key itself was the victim
+        }
+        chargeEviction(*victim, stats, evicted, *bytes, expiry);
+    }
+    
+    auto victim = policy.putSized(key, value, size);
+    if (victim) {
+        chargeEviction(*victim, stats, evicted, *bytes, expiry);
+    }
+    
+    bytes->used = bytes->used - oldSize + size;
+    bytes->sizes[key] = size;
+}
+
+void Simulator::chargeEviction(const std::string& victim, Stats& stats,
+                               std::optional<std::string>& evicted, ByteLedger& bytes,
+                               TimingWheel* expiry) {
+    uint64_t size = bytes.sizes[victim];
+    bytes.forget(victim);
+    bytes.used -= size;
+    stats.bytesEvicted += size;
+    stats.evictions++;
+    if (expiry) expiry->cancel(victim);
+    if (!evicted) {
+        evicted = victim;
+    }
+}
+
+void Simulator::setExpiry(const TraceOp& op, const IPolicy& policy, TimingWheel& expiry) {
+    if (op.ttl == 0) {
+        expiry.cancel(op.key); // a write without a TTL never expires
+    } else if (policy.isCacheHit(op.key)) { // not when the policy declined to admit it
+        expiry.schedule(op.key, expiry.now() + op.ttl);
+    }
 }
 
-Step Simulator::createStep(int index, const TraceOp& op, bool hit, 
+Step Simulator::createStep(size_t index, const TraceOp& op, bool hit, 
                           const std::optional<std::string>& evicted, 
-                          const IPolicy& policy) {
+                          const IPolicy& policy, const Stats& stats) {
     Step step;
-    step.index = index;
-    step.op = (op.kind == TraceOp::Kind::GET) ? "GET" : "PUT";
+    step.index = static_cast<int>(index);
+    step.op = op.kind == TraceOp::Kind::GET ? "GET" : op.kind == TraceOp::Kind::PUT ? "PUT" : "DEL";
     step.key = op.key;
     step.value = op.value;
     step.hit = hit;
     step.evicted = evicted;
     step.cache = policy.snapshot();
+    step.totals = stats;
+    step.totals.hitPathWrites = policy.hitPathWrites();
     
     // Get policy-specific metadata for UI
     policy.metaForUI(step);
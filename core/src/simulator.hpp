@@ -1,19 +1,95 @@
 #pragma once
 
 #include "../include/types.hpp"
+#include "step_recorder.hpp"
+#include "time_series.hpp"
+#include "timing_wheel.hpp"
 #include <memory>
+#include <unordered_map>
 #include <vector>
 
 namespace cachesim {
 
+// Heap bytes of one cached entry in a policy besides its key and value
+// (hash node, queue/list node, metadata and a share of ghosts); measured
+// at 150-500 across the policies. Used for rough footprint estimates.
+constexpr uint64_t kPolicyEntryBytes = 256;
+
+// Byte bookkeeping for one replay: resident bytes and the last known size
+// of each key (so misses can be charged in bytes too). While every op
+// carries its own size, as in the imported trace formats, departed keys'
+// sizes are dropped, so the map stays bounded by the cache rather than by
+// the trace's key count.
+struct ByteLedger {
+    uint64_t capacity = 0; // 0 = track only, no byte budget
+    uint64_t used = 0;
+    std::unordered_map<std::string, uint64_t> sizes;
+    bool sizedOps = true; // no op so far lacked a size
+
+    // Called when `key` leaves the cache
+    void forget(const std::string& key) {
+        if (sizedOps) sizes.erase(key);
+    }
+};
+
+// Everything besides the policy that a replay carries from op to op;
+// copyable, so a replay can be checkpointed and resumed
+struct ReplayState {
+    Stats stats;
+    ByteLedger ledger;
+    std::optional<TimeSeriesRecorder> series;
+    StepRecorder recorder;
+    TimingWheel expiry; // TTL timers of resident keys; its clock is the trace time
+};
+
 class Simulator {
 public:
     SimResult run(const std::vector<TraceOp>& ops, IPolicy& policy, const SimConfig& cfg);
     
+    // Building blocks of run() for callers that pause and resume a replay.
+    // replay() applies ops [begin, end) and appends recorded steps to `result`;
+    // finish() moves the final stats, time series and fidelity into `result`.
+    static ReplayState initialState(const SimConfig& cfg);
+    static void replay(const std::vector<TraceOp>& ops, size_t begin, size_t end, IPolicy& policy,
+                       const SimConfig& cfg, ReplayState& state, SimResult& result);
+    static void finish(const IPolicy& policy, ReplayState& state, SimResult& result);
+    
+    // Applies one op to `policy` and updates `stats`; returns whether it counted as a hit.
+    // With a ledger, byte stats are kept and a byte budget is enforced by
+    // evicting until the new object fits. `evicted` receives the first victim.
+    // With a timing wheel, entries whose TTL has run out by op.timestamp are
+    // dropped first (counted in stats.expirations), and inserts with a ttl
+    // schedule their expiry. A DEL erases the key from the policy and the
+    // ledger without touching hit, miss or eviction counts.
+    static bool applyOp(const TraceOp& op, IPolicy& policy, Stats& stats,
+                        std::optional<std::string>& evicted, ByteLedger* bytes = nullptr,
+                        TimingWheel* expiry = nullptr);
+    
+    // Applies ops [first, last) in order, as repeated applyOp() calls. With
+    // prefetchBatch > 0 the ops go in groups of that size and the policy's
+    // prefetch() runs over each group first, so their hash-probe misses
+    // overlap; results are identical either way.
+    static void applyBatch(const TraceOp* first, const TraceOp* last, IPolicy& policy, Stats& stats,
+                           ByteLedger* bytes = nullptr, size_t prefetchBatch = 0,
+                           TimingWheel* expiry = nullptr);
+    
+    
 private:
-    Step createStep(int index, const TraceOp& op, bool hit, 
-                   const std::optional<std::string>& evicted, 
-                   const IPolicy& policy);
+    // Inserts or updates `key`, enforcing the byte budget when there is a ledger
+    static void store(const std::string& key, const std::string& value, uint64_t size,
+                      IPolicy& policy, Stats& stats, std::optional<std::string>& evicted,
+                      ByteLedger* bytes, TimingWheel* expiry);
+    
+    static void chargeEviction(const std::string& victim, Stats& stats,
+                               std::optional<std::string>& evicted, ByteLedger& bytes,
+                               TimingWheel* expiry);
+    
+    // Starts, replaces or clears the TTL timer of a key the op just wrote
+    static void setExpiry(const TraceOp& op, const IPolicy& policy, TimingWheel& expiry);
+
+    static Step createStep(size_t index, const TraceOp& op, bool hit, 
+                           const std::optional<std::string>& evicted, 
+                           const IPolicy& policy, const Stats& stats);
 };
 
 } // namespace cachesim
@@ -0,0 +1,416 @@
+#include "step_log.hpp"
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace cachesim {
+
+// File layout, all integers little-endian:
+//   header   "CSIMSTEP", u32 version, u32 ops per block
+//   blocks   u32 ops, u32 encoded bytes of each of the 7 columns, then the
+//            columns in StepColumns order: kind 2 bits per op, hit/ghostHit
+//            bit-packed,
+//            key and evicted+1 (0 = none) as varints, arcP and
+//            keyFrequency as zigzag varint deltas from the previous op
+//            (0 before the block's first op)
+//   keys     u64 count, then varint length + bytes per key, by ID
+//   index    u64 file offset of each block
+//   trailer  u64 ops, u64 blocks, u64 keys offset, u64 index offset, "CSIMSEND"
+
+namespace {
+
+constexpr char kMagic[8] = {'C', 'S', 'I', 'M', 'S', 'T', 'E', 'P'};
+constexpr char kEndMagic[8] = {'C', 'S', 'I', 'M', 'S', 'E', 'N', 'D'};
+// 1 logged LFU's minimum frequency instead of keyFrequency; 2 had a 1-bit kind (no DEL)
+constexpr uint32_t kVersion = 3;
+constexpr size_t kColumns = 7;
+constexpr size_t kHeaderBytes = 16;
+constexpr size_t kTrailerBytes = 40;
+constexpr size_t kMaxQueuedBlocks = 2;
+
+// Threads are unavailable in a wasm build without -pthread
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+constexpr bool kHaveThreads = false;
+#else
+constexpr bool kHaveThreads = true;
+#endif
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+uint64_t zigzag(int64_t value) { return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63); }
+int64_t unzigzag(uint64_t value) { return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1); }
+
+// Packs `width` (1, 2, 4 or 8) low bits of each value, first value lowest
+void putBits(std::vector<uint8_t>& out, const std::vector<uint8_t>& values, size_t width = 1) {
+    size_t start = out.size();
+    size_t perByte = 8 / width;
+    uint8_t mask = static_cast<uint8_t>((1u << width) - 1);
+    out.resize(start + (values.size() + perByte - 1) / perByte);
+    for (size_t i = 0; i < values.size(); ++i) {
+        out[start + i / perByte] |= static_cast<uint8_t>((values[i] & mask) << (i % perByte * width));
+    }
+}
+
+template <typename T>
+void putLittleEndian(std::vector<uint8_t>& out, T value) {
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        out.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (8 * i)));
+    }
+}
+
+template <typename T>
+T loadLittleEndian(const uint8_t* p) {
+    uint64_t value = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+        value |= uint64_t(p[i]) << (8 * i);
+    }
+    return static_cast<T>(value);
+}
+
+// Bounds-checked reads from one region of the map
+class Cursor {
+public:
+    Cursor(const uint8_t* begin, const uint8_t* end) : p_(begin), end_(end) {}
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            need(1);
+            uint8_t byte = *p_++;
+            value |= uint64_t(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        throw std::runtime_error("Corrupt step log: bad varint");
+    }
+
+    const uint8_t* take(size_t bytes) {
+        need(bytes);
+        const uint8_t* at = p_;
+        p_ += bytes;
+        return at;
+    }
+
+private:
+    const uint8_t* p_;
+    const uint8_t* end_;
+
+    void need(size_t bytes) const {
+        if (size_t(end_ - p_) < bytes) throw std::runtime_error("Corrupt step log: truncated");
+    }
+};
+
+void getBits(Cursor cursor, size_t ops, std::vector<uint8_t>& values, size_t width = 1) {
+    size_t perByte = 8 / width;
+    uint8_t mask = static_cast<uint8_t>((1u << width) - 1);
+    const uint8_t* bits = cursor.take((ops + perByte - 1) / perByte);
+    values.resize(ops);
+    for (size_t i = 0; i < ops; ++i) {
+        values[i] = (bits[i / perByte] >> (i % perByte * width)) & mask;
+    }
+}
+
+} // namespace
+
+void StepColumns::clear() {
+    kind.clear();
+    hit.clear();
+    ghostHit.clear();
+    key.clear();
+    evicted.clear();
+    arcP.clear();
+    keyFrequency.clear();
+}
+
+void StepColumns::reserve(size_t ops) {
+    kind.reserve(ops);
+    hit.reserve(ops);
+    ghostHit.reserve(ops);
+    key.reserve(ops);
+    evicted.reserve(ops);
+    arcP.reserve(ops);
+    keyFrequency.reserve(ops);
+}
+
+StepLogWriter::StepLogWriter(const std::string& path) : file_(std::fopen(path.c_str(), "wb")) {
+    if (!file_) {
+        throw std::runtime_error("Cannot create step log: " + path);
+    }
+    std::vector<uint8_t> header(kMagic, kMagic + 8);
+    putLittleEndian<uint32_t>(header, kVersion);
+    putLittleEndian<uint32_t>(header, kBlockOps);
+    write(header.data(), header.size());
+    current_.reserve(kBlockOps);
+    if (kHaveThreads) {
+        worker_ = std::thread([this]() { run(); });
+    }
+}
+
+StepLogWriter::~StepLogWriter() {
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+uint32_t StepLogWriter::idOf(const std::string& key) {
+    auto [it, inserted] = ids_.try_emplace(key, static_cast<uint32_t>(keys_.size()));
+    if (inserted) {
+        if (keys_.size() >= StepRecord::kNoKey) {
+            throw std::runtime_error("Step log supports at most 2^32 - 1 distinct keys");
+        }
+        keys_.push_back(&it->first);
+    }
+    return it->second;
+}
+
+void StepLogWriter::append(const TraceOp& op, bool hit, bool ghostHit, const std::optional<std::string>& evicted,
+                           int32_t arcP, int32_t keyFrequency) {
+    current_.kind.push_back(static_cast<uint8_t>(op.kind));
+    current_.hit.push_back(hit ? 1 : 0);
+    current_.ghostHit.push_back(ghostHit ? 1 : 0);
+    current_.key.push_back(idOf(op.key));
+    current_.evicted.push_back(evicted ? idOf(*evicted) : StepRecord::kNoKey);
+    current_.arcP.push_back(arcP);
+    current_.keyFrequency.push_back(keyFrequency);
+    ++ops_;
+    if (current_.size() == kBlockOps) {
+        submit();
+    }
+}
+
+void StepLogWriter::submit() {
+    if (!kHaveThreads) {
+        writeBlock(current_);
+        current_.clear();
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    // Backpressure: the replay waits rather than queueing unbounded blocks
+    changed_.wait(lock, [this]() { return queue_.size() < kMaxQueuedBlocks; });
+    if (!error_.empty()) {
+        throw std::runtime_error(error_);
+    }
+    queue_.push_back(std::move(current_));
+    lock.unlock();
+    changed_.notify_all();
+    current_ = StepColumns();
+    current_.reserve(kBlockOps);
+}
+
+void StepLogWriter::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        changed_.wait(lock, [this]() { return done_ || !queue_.empty(); });
+        if (queue_.empty()) return;
+        StepColumns block = std::move(queue_.front());
+        lock.unlock();
+        std::string error;
+        try {
+            writeBlock(block);
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        lock.lock();
+        queue_.pop_front();
+        if (!error.empty() && error_.empty()) {
+            error_ = error;
+        }
+        changed_.notify_all();
+    }
+}
+
+void StepLogWriter::writeBlock(const StepColumns& block) {
+    size_t ops = block.size();
+    std::vector<uint8_t> columns[kColumns];
+    putBits(columns[0], block.kind, 2);
+    putBits(columns[1], block.hit);
+    putBits(columns[2], block.ghostHit);
+    int32_t lastP = 0, lastFrequency = 0;
+    for (size_t i = 0; i < ops; ++i) {
+        putVarint(columns[3], block.key[i]);
+        putVarint(columns[4], block.evicted[i] == StepRecord::kNoKey ? 0 : uint64_t(block.evicted[i]) + 1);
+        putVarint(columns[5], zigzag(int64_t(block.arcP[i]) - lastP));
+        putVarint(columns[6], zigzag(int64_t(block.keyFrequency[i]) - lastFrequency));
+        lastP = block.arcP[i];
+        lastFrequency = block.keyFrequency[i];
+    }
+
+    std::vector<uint8_t> header;
+    putLittleEndian<uint32_t>(header, static_cast<uint32_t>(ops));
+    for (const auto& column : columns) {
+        putLittleEndian<uint32_t>(header, static_cast<uint32_t>(column.size()));
+    }
+    block_offsets_.push_back(position_);
+    write(header.data(), header.size());
+    for (const auto& column : columns) {
+        write(column.data(), column.size());
+    }
+}
+
+void StepLogWriter::write(const void* data, size_t size) {
+    if (size && std::fwrite(data, 1, size, file_) != size) {
+        throw std::runtime_error("Step log write failed");
+    }
+    position_ += size;
+}
+
+void StepLogWriter::close() {
+    if (closed_) return;
+    closed_ = true;
+    if (current_.size() > 0) {
+        if (kHaveThreads) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(std::move(current_));
+        } else {
+            writeBlock(current_);
+        }
+    }
+    if (kHaveThreads) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            done_ = true;
+        }
+        changed_.notify_all();
+        worker_.join();
+    }
+
+    std::string error = error_;
+    if (error.empty()) {
+        try {
+            std::vector<uint8_t> tail;
+            uint64_t keysOffset = position_;
+            putLittleEndian<uint64_t>(tail, keys_.size());
+            for (const std::string* key : keys_) {
+                putVarint(tail, key->size());
+                tail.insert(tail.end(), key->begin(), key->end());
+            }
+            uint64_t indexOffset = keysOffset + tail.size();
+            for (uint64_t offset : block_offsets_) {
+                putLittleEndian<uint64_t>(tail, offset);
+            }
+            putLittleEndian<uint64_t>(tail, ops_);
+            putLittleEndian<uint64_t>(tail, block_offsets_.size());
+            putLittleEndian<uint64_t>(tail, keysOffset);
+            putLittleEndian<uint64_t>(tail, indexOffset);
+            tail.insert(tail.end(), kEndMagic, kEndMagic + 8);
+            write(tail.data(), tail.size());
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+    }
+    if (std::fclose(file_) != 0 && error.empty()) {
+        error = "Step log close failed";
+    }
+    file_ = nullptr;
+    if (!error.empty()) {
+        throw std::runtime_error(error);
+    }
+}
+
+StepLogReader::StepLogReader(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw std::runtime_error("Cannot open step log: " + path);
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || size_t(info.st_size) < kHeaderBytes + kTrailerBytes) {
+        ::close(fd);
+        throw std::runtime_error("Not a step log: " + path);
+    }
+    bytes_ = size_t(info.st_size);
+    void* map = mmap(nullptr, bytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        throw std::runtime_error("Cannot map step log: " + path);
+    }
+    data_ = static_cast<const uint8_t*>(map);
+
+    const uint8_t* trailer = data_ + bytes_ - kTrailerBytes;
+    if (std::memcmp(data_, kMagic, 8) != 0 || std::memcmp(trailer + 32, kEndMagic, 8) != 0 ||
+        loadLittleEndian<uint32_t>(data_ + 8) != kVersion || loadLittleEndian<uint32_t>(data_ + 12) == 0) {
+        munmap(const_cast<uint8_t*>(data_), bytes_);
+        throw std::runtime_error("Not a step log (or not closed): " + path);
+    }
+    block_ops_ = loadLittleEndian<uint32_t>(data_ + 12);
+    ops_ = loadLittleEndian<uint64_t>(trailer);
+    uint64_t blocks = loadLittleEndian<uint64_t>(trailer + 8);
+    uint64_t keysOffset = loadLittleEndian<uint64_t>(trailer + 16);
+    uint64_t indexOffset = loadLittleEndian<uint64_t>(trailer + 24);
+    if (keysOffset > indexOffset || indexOffset + blocks * 8 != bytes_ - kTrailerBytes) {
+        munmap(const_cast<uint8_t*>(data_), bytes_);
+        throw std::runtime_error("Corrupt step log: " + path);
+    }
+
+    keys_offset_ = keysOffset;
+    offsets_.resize(blocks);
+    for (uint64_t b = 0; b < blocks; ++b) {
+        offsets_[b] = loadLittleEndian<uint64_t>(data_ + indexOffset + 8 * b);
+        if (offsets_[b] < (b ? offsets_[b - 1] : kHeaderBytes) || offsets_[b] > keysOffset) {
+            munmap(const_cast<uint8_t*>(data_), bytes_);
+            throw std::runtime_error("Corrupt step log: " + path);
+        }
+    }
+    Cursor keys(data_ + keysOffset, data_ + indexOffset);
+    uint64_t count = loadLittleEndian<uint64_t>(keys.take(8));
+    keys_.reserve(count);
+    for (uint64_t i = 0; i < count; ++i) {
+        size_t length = keys.varint();
+        keys_.emplace_back(reinterpret_cast<const char*>(keys.take(length)), length);
+    }
+}
+
+StepLogReader::~StepLogReader() {
+    munmap(const_cast<uint8_t*>(data_), bytes_);
+}
+
+const StepColumns& StepLogReader::block(size_t b) const {
+    if (b == cached_block_) return cached_;
+    uint64_t begin = offsets_.at(b);
+    uint64_t end = b + 1 < offsets_.size() ? offsets_[b + 1] : keys_offset_;
+    Cursor cursor(data_ + begin, data_ + end);
+    const uint8_t* header = cursor.take(4 * (1 + kColumns));
+    size_t ops = loadLittleEndian<uint32_t>(header);
+    Cursor columns[kColumns] = {cursor, cursor, cursor, cursor, cursor, cursor, cursor};
+    for (size_t c = 0; c < kColumns; ++c) {
+        size_t size = loadLittleEndian<uint32_t>(header + 4 * (c + 1));
+        const uint8_t* at = cursor.take(size);
+        columns[c] = Cursor(at, at + size);
+    }
+
+    cached_block_ = SIZE_MAX; // stays invalid if decoding throws
+    cached_.clear();
+    getBits(columns[0], ops, cached_.kind, 2);
+    getBits(columns[1], ops, cached_.hit);
+    getBits(columns[2], ops, cached_.ghostHit);
+    int64_t p = 0, frequency = 0;
+    for (size_t i = 0; i < ops; ++i) {
+        cached_.key.push_back(static_cast<uint32_t>(columns[3].varint()));
+        uint64_t evicted = columns[4].varint();
+        cached_.evicted.push_back(evicted == 0 ? StepRecord::kNoKey : static_cast<uint32_t>(evicted - 1));
+        p += unzigzag(columns[5].varint());
+        frequency += unzigzag(columns[6].varint());
+        cached_.arcP.push_back(static_cast<int32_t>(p));
+        cached_.keyFrequency.push_back(static_cast<int32_t>(frequency));
+    }
+    cached_block_ = b;
+    return cached_;
+}
+
+StepRecord StepLogReader::at(uint64_t index) const {
+    if (index >= ops_) {
+        throw std::out_of_range("Step index out of range");
+    }
+    return block(size_t(index / block_ops_)).at(size_t(index % block_ops_));
+}
+
+} // namespace cachesim
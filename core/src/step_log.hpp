@@ -0,0 +1,127 @@
+#pragma once
+
+#include "../include/types.hpp"
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace cachesim {
+
+// One op's outcome as stored in a step log
+struct StepRecord {
+    static constexpr uint32_t kNoKey = UINT32_MAX;
+
+    uint8_t kind;             // TraceOp::Kind: 0 = GET, 1 = PUT, 2 = DEL
+    bool hit;
+    bool ghostHit;            // ARC: the key was in a ghost list (counted as a miss)
+    uint32_t key;             // key ID, see StepLogReader::key()
+    uint32_t evicted;         // first victim's key ID, or kNoKey
+    int32_t arcP;             // ARC's p after the op; -1 = n/a
+    int32_t keyFrequency;     // IPolicy::keyFrequency of the op's key after the op; -1 = n/a
+};
+
+// Fixed-width columns for up to StepLogWriter::kBlockOps consecutive ops
+struct StepColumns {
+    std::vector<uint8_t> kind, hit, ghostHit;
+    std::vector<uint32_t> key, evicted;
+    std::vector<int32_t> arcP, keyFrequency;
+
+    size_t size() const { return kind.size(); }
+    void clear();
+    void reserve(size_t ops);
+    StepRecord at(size_t i) const {
+        return StepRecord{kind[i], hit[i] != 0, ghostHit[i] != 0, key[i], evicted[i], arcP[i], keyFrequency[i]};
+    }
+};
+
+// Streams every op's outcome to an append-only columnar file, so per-op
+// detail for long native runs costs disk bandwidth instead of heap. Ops are
+// buffered in fixed-width columns; each full block of kBlockOps is handed to
+// a background thread that compresses it (bit-packed flags, varint key IDs,
+// delta-coded gauges) and appends it. Keys are numbered in first-seen order
+// and the key table is written by close(). Not thread-safe; throws
+// std::runtime_error on I/O errors.
+//
+// Layout: header, blocks, key table, block index, trailer (see step_log.cpp).
+class StepLogWriter {
+public:
+    static constexpr size_t kBlockOps = 1 << 16;
+
+    explicit StepLogWriter(const std::string& path);
+    ~StepLogWriter(); // closes; errors are lost, so call close() to see them
+    StepLogWriter(const StepLogWriter&) = delete;
+    StepLogWriter& operator=(const StepLogWriter&) = delete;
+
+    void append(const TraceOp& op, bool hit, bool ghostHit, const std::optional<std::string>& evicted,
+                int32_t arcP, int32_t keyFrequency);
+
+    // Flushes the last block and writes the key table and index
+    void close();
+
+    uint64_t ops() const { return ops_; }
+
+private:
+    std::FILE* file_;
+    std::unordered_map<std::string, uint32_t> ids_;
+    std::vector<const std::string*> keys_; // by ID, owned by ids_
+    StepColumns current_;
+    uint64_t ops_ = 0;
+    bool closed_ = false;
+
+    // Shared with the writer thread
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    std::deque<StepColumns> queue_;
+    bool done_ = false;
+    std::string error_;
+    std::vector<uint64_t> block_offsets_;
+    uint64_t position_ = 0; // bytes written so far
+    std::thread worker_;
+
+    uint32_t idOf(const std::string& key);
+    void submit();
+    void run();                                // writer thread
+    void writeBlock(const StepColumns& block); // compresses and appends one block
+    void write(const void* data, size_t size);
+};
+
+// Reads a step log through a read-only memory map. Blocks are decoded on
+// demand (the last one is cached), key strings are views into the map.
+class StepLogReader {
+public:
+    explicit StepLogReader(const std::string& path); // throws std::runtime_error
+    ~StepLogReader();
+    StepLogReader(const StepLogReader&) = delete;
+    StepLogReader& operator=(const StepLogReader&) = delete;
+
+    uint64_t size() const { return ops_; }
+    StepRecord at(uint64_t index) const;
+    std::string_view key(uint32_t id) const { return keys_.at(id); }
+    size_t keyCount() const { return keys_.size(); }
+    uint64_t fileBytes() const { return bytes_; }
+
+    // Decoded columns of block b (ops [b * blockOps, ...)); valid until the next call
+    const StepColumns& block(size_t b) const;
+    size_t blockCount() const { return offsets_.size(); }
+    size_t blockOps() const { return block_ops_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t bytes_ = 0;
+    uint64_t ops_ = 0;
+    size_t block_ops_ = 0;
+    uint64_t keys_offset_ = 0; // end of the last block
+    std::vector<uint64_t> offsets_;
+    std::vector<std::string_view> keys_;
+    mutable StepColumns cached_;
+    mutable size_t cached_block_ = SIZE_MAX;
+};
+
+} // namespace cachesim
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "../include/types.hpp"
+#include <algorithm>
+
+namespace cachesim {
+
+// Decides which ops get a recorded Step and keeps their estimated memory
+// under a byte budget. Ops on the stride grid (index % stride == 0) are
+// recorded, plus the trace's final op. When the recorded steps outgrow the
+// budget, every other one is dropped and the stride doubles, so detail
+// degrades evenly across the trace instead of stopping at a fixed length.
+class StepRecorder {
+public:
+    explicit StepRecorder(size_t stride = 1, uint64_t budget = 0) {
+        fidelity_.requestedStride = std::max<size_t>(stride, 1);
+        fidelity_.stride = fidelity_.requestedStride;
+        fidelity_.budget = budget;
+    }
+
+    bool wants(size_t index, bool finalOp) const {
+        return finalOp || index % fidelity_.stride == 0;
+    }
+
+    void add(Step step, std::vector<Step>& steps, bool finalOp) {
+        uint64_t bytes = estimateBytes(step);
+        bool offGrid = step.index % fidelity_.stride != 0;
+        fidelity_.bytes += bytes;
+        steps.push_back(std::move(step));
+        // Stop once thinning frees nothing (only op 0 and the final op left)
+        bool thinned = false;
+        while (fidelity_.budget > 0 && fidelity_.bytes > fidelity_.budget && thin(steps, finalOp)) {
+            offGrid = steps.back().index % fidelity_.stride != 0;
+            thinned = true;
+        }
+        final_bytes_ = finalOp && offGrid ? bytes : 0;
+        final_thinned_ = finalOp && thinned;
+        fidelity_.steps = steps.size();
+    }
+
+    // Whether adding the final op's step thinned the steps. Thinning keeps
+    // the final step, so a longer trace would have thinned differently (or
+    // not at all) and the dropped steps are gone: resumeAt() can't be used.
+    bool finalThinned() const { return final_thinned_; }
+
+    // Prepares `steps` (recorded by an earlier run with this recorder's
+    // stride) for a replay resuming at op `begin`: drops steps from `begin`
+    // on and the earlier trace's off-grid final step. Not after finalThinned().
+    void resumeAt(size_t begin, std::vector<Step>& steps) {
+        while (!steps.empty() && (static_cast<size_t>(steps.back().index) >= begin ||
+                                  steps.back().index % fidelity_.stride != 0)) {
+            steps.pop_back();
+        }
+        fidelity_.bytes -= final_bytes_;
+        final_bytes_ = 0;
+        fidelity_.steps = steps.size();
+    }
+
+    void setBudget(uint64_t budget) { fidelity_.budget = budget; }
+
+    size_t stride() const { return fidelity_.stride; }
+    const RecordingFidelity& fidelity() const { return fidelity_; }
+
+    // Rough heap footprint of a Step: the struct, its strings and the
+    // cache / metadata containers
+    static uint64_t estimateBytes(const Step& step) {
+        uint64_t bytes = sizeof(Step) + step.key.size() + step.value.size();
+        if (step.evicted) bytes += step.evicted->size();
+        for (const auto& [key, value] : step.cache) {
+            bytes += sizeof(std::pair<std::string, std::string>) + key.size() + value.size();
+        }
+        for (const auto& [key, freq] : step.freq) {
+            bytes += 4 * sizeof(void*) + sizeof(std::string) + sizeof(int) + key.size();
+        }
+        if (step.arc) {
+            for (const auto* list : {&step.arc->T1, &step.arc->T2, &step.arc->B1, &step.arc->B2}) {
+                for (const auto& key : *list) bytes += sizeof(std::string) + key.size();
+            }
+        }
+        return bytes;
+    }
+
+private:
+    RecordingFidelity fidelity_;
+    uint64_t final_bytes_ = 0; // bytes of a kept off-grid final step
+    bool final_thinned_ = false;
+
+    // Double the stride and keep the steps still on the grid (and the
+    // newest one if it is the trace's final op); returns whether any went.
+    // The stride only doubles if a step went, so it never outgrows the trace.
+    bool thin(std::vector<Step>& steps, bool finalOp) {
+        size_t stride = fidelity_.stride * 2;
+        auto keep = [&](size_t i) {
+            return (finalOp && i + 1 == steps.size()) || steps[i].index % stride == 0;
+        };
+        size_t kept = 0;
+        while (kept < steps.size() && keep(kept)) ++kept;
+        if (kept == steps.size()) {
+            return false;
+        }
+        fidelity_.stride = stride;
+        fidelity_.bytes = 0;
+        kept = 0;
+        for (size_t i = 0; i < steps.size(); ++i) {
+            if (keep(i)) {
+                fidelity_.bytes += estimateBytes(steps[i]);
+                if (kept != i) steps[kept] = std::move(steps[i]);
+                ++kept;
+            }
+        }
+        steps.resize(kept);
+        return true;
+    }
+};
+
+} // namespace cachesim
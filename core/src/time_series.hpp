@@ -0,0 +1,103 @@
+#pragma once
+
+#include "../include/types.hpp"
+#include <algorithm>
+
+namespace cachesim {
+
+// Builds a TimeSeries while the simulator runs. Counters are taken as deltas
+// of the running Stats at each window boundary, so the per-op cost is one
+// increment and compare. Once kMaxWindows windows exist, adjacent pairs are
+// merged and the window length doubles - a 10M-op run still costs ~24 KB.
+class TimeSeriesRecorder {
+public:
+    static constexpr size_t kMaxWindows = 1024;
+
+    TimeSeriesRecorder(size_t window, double alpha) : alpha_(std::min(alpha, 1.0)) {
+        series_.window = std::max<size_t>(window, 1);
+        series_.hits.reserve(kMaxWindows);
+        series_.misses.reserve(kMaxWindows);
+        series_.evictions.reserve(kMaxWindows);
+        series_.arcP.reserve(kMaxWindows);
+        series_.lfuMinFrequency.reserve(kMaxWindows);
+        if (alpha_ > 0) {
+            series_.smoothedMissRatio.reserve(kMaxWindows);
+        }
+    }
+
+    // Call after every op with the cumulative stats
+    void onOp(const Stats& stats, const IPolicy& policy) {
+        if (++ops_in_window_ == series_.window) {
+            closeWindow(stats, policy);
+        }
+    }
+
+    // Flushes a trailing partial window
+    void finish(const Stats& stats, const IPolicy& policy) {
+        if (ops_in_window_ > 0) {
+            closeWindow(stats, policy);
+        }
+    }
+
+    TimeSeries take() { return std::move(series_); }
+
+private:
+    TimeSeries series_;
+    double alpha_;
+    double smoothed_ = -1.0; // -1 until the first window with GETs
+    size_t ops_in_window_ = 0;
+    Stats last_;
+
+    void closeWindow(const Stats& stats, const IPolicy& policy) {
+        uint32_t hits = static_cast<uint32_t>(stats.hits - last_.hits);
+        uint32_t misses = static_cast<uint32_t>(stats.misses - last_.misses);
+        series_.hits.push_back(hits);
+        series_.misses.push_back(misses);
+        series_.evictions.push_back(static_cast<uint32_t>(stats.evictions - last_.evictions));
+
+        PolicyGauges gauges = policy.gauges();
+        series_.arcP.push_back(gauges.arcP);
+        series_.lfuMinFrequency.push_back(gauges.lfuMinFrequency);
+
+        if (alpha_ > 0) {
+            if (hits + misses > 0) {
+                double ratio = double(misses) / double(hits + misses);
+                smoothed_ = smoothed_ < 0 ? ratio : alpha_ * ratio + (1.0 - alpha_) * smoothed_;
+            }
+            series_.smoothedMissRatio.push_back(smoothed_ < 0 ? 0.0f : static_cast<float>(smoothed_));
+        }
+
+        last_ = stats;
+        ops_in_window_ = 0;
+        if (series_.hits.size() == kMaxWindows) {
+            compact();
+        }
+    }
+
+    // Merge windows (2i, 2i+1) into i. Counters add; gauges and the smoothed
+    // ratio keep the later window's value since they are end-of-window samples.
+    void compact() {
+        size_t half = series_.hits.size() / 2;
+        for (size_t i = 0; i < half; ++i) {
+            series_.hits[i] = series_.hits[2 * i] + series_.hits[2 * i + 1];
+            series_.misses[i] = series_.misses[2 * i] + series_.misses[2 * i + 1];
+            series_.evictions[i] = series_.evictions[2 * i] + series_.evictions[2 * i + 1];
+            series_.arcP[i] = series_.arcP[2 * i + 1];
+            series_.lfuMinFrequency[i] = series_.lfuMinFrequency[2 * i + 1];
+            if (alpha_ > 0) {
+                series_.smoothedMissRatio[i] = series_.smoothedMissRatio[2 * i + 1];
+            }
+        }
+        series_.hits.resize(half);
+        series_.misses.resize(half);
+        series_.evictions.resize(half);
+        series_.arcP.resize(half);
+        series_.lfuMinFrequency.resize(half);
+        if (alpha_ > 0) {
+            series_.smoothedMissRatio.resize(half);
+        }
+        series_.window *= 2;
+    }
+};
+
+} // namespace cachesim
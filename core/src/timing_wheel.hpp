@@ -0,0 +1,202 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace cachesim {
+
+// Per-key expiry timers on a hierarchical timing wheel, in trace seconds.
+// Level L has 64 slots of 64^L seconds each. A timer sits in the lowest
+// level whose span covers its remaining time and moves down a level when
+// its slot comes round ("cascading"), so schedule() and cancel() are O(1)
+// and a timer is touched at most once per level before it fires. Each level
+// keeps a 64-bit occupancy mask, so advance() jumps straight to the next
+// occupied slot and long idle stretches of the clock cost nothing.
+class TimingWheel {
+public:
+    TimingWheel() { heads_.fill(kNone); }
+
+    // Copies rebind each node to its key in the copied index
+    TimingWheel(const TimingWheel& other)
+        : nodes_(other.nodes_), heads_(other.heads_), masks_(other.masks_), index_(other.index_),
+          free_(other.free_), now_(other.now_) {
+        for (const auto& entry : index_) {
+            nodes_[entry.second].key = &entry.first;
+        }
+    }
+    TimingWheel& operator=(const TimingWheel& other) {
+        TimingWheel copy(other);
+        *this = std::move(copy);
+        return *this;
+    }
+    TimingWheel(TimingWheel&&) = default; // map nodes keep their addresses
+    TimingWheel& operator=(TimingWheel&&) = default;
+
+    size_t size() const { return index_.size(); }
+    bool empty() const { return index_.empty(); }
+    uint64_t now() const { return now_; }
+
+    // Sets or replaces the timer of `key`. Expiry times not after now() are
+    // treated as now() + 1, so they fire on the next advance.
+    void schedule(const std::string& key, uint64_t expiry) {
+        auto [it, inserted] = index_.try_emplace(key, kNone);
+        if (inserted) {
+            it->second = allocate();
+            nodes_[it->second].key = &it->first;
+        } else {
+            unlink(it->second);
+        }
+        nodes_[it->second].expiry = std::max(expiry, now_ + 1);
+        place(it->second);
+    }
+
+    // Drops the timer of `key`; returns whether it had one
+    bool cancel(const std::string& key) {
+        if (index_.empty()) return false;
+        auto it = index_.find(key);
+        if (it == index_.end()) return false;
+        unlink(it->second);
+        release(it->second);
+        index_.erase(it);
+        return true;
+    }
+
+    // Moves the clock to `now` (it never goes back) and calls onExpire(key)
+    // for every timer with expiry <= now, slot by slot in time order. The
+    // callback must not schedule or cancel timers.
+    template <typename OnExpire>
+    void advance(uint64_t now, OnExpire&& onExpire) {
+        while (now_ < now) {
+            uint64_t next = empty() ? now : std::min(now, nextEvent());
+            now_ = next;
+            if (empty()) return;
+            // Higher levels first, so their timers can land in this tick's slot
+            for (size_t level = kLevels - 1; level > 0; --level) {
+                if (now_ % span(level) == 0) {
+                    cascade(level);
+                }
+            }
+            expire(onExpire);
+        }
+    }
+
+private:
+    static constexpr size_t kBits = 6;
+    static constexpr size_t kSlots = size_t(1) << kBits;
+    static constexpr uint64_t kMask = kSlots - 1;
+    static constexpr size_t kLevels = 6; // 64^6 s (~2000 years); longer timers park in the top level
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    struct Node {
+        const std::string* key; // owned by index_
+        uint64_t expiry;
+        uint32_t prev, next;    // slot list, or `next` links the free list
+        uint16_t bucket;        // level * kSlots + slot
+    };
+
+    std::vector<Node> nodes_;
+    std::array<uint32_t, kLevels * kSlots> heads_;
+    std::array<uint64_t, kLevels> masks_{}; // bit s = slot s is occupied
+    std::unordered_map<std::string, uint32_t> index_; // key -> node
+    uint32_t free_ = kNone;
+    uint64_t now_ = 0;
+
+    static uint64_t span(size_t level) { return uint64_t(1) << (kBits * level); }
+
+    uint32_t allocate() {
+        if (free_ == kNone) {
+            nodes_.push_back(Node{});
+            return static_cast<uint32_t>(nodes_.size() - 1);
+        }
+        uint32_t i = free_;
+        free_ = nodes_[i].next;
+        return i;
+    }
+
+    void release(uint32_t i) {
+        nodes_[i].next = free_;
+        free_ = i;
+    }
+
+    // Links node i into the slot for its expiry relative to now_
+    void place(uint32_t i) {
+        Node& node = nodes_[i];
+        uint64_t delta = node.expiry - now_;
+        size_t level = 0;
+        while (level + 1 < kLevels && delta >= span(level + 1)) ++level;
+        uint64_t slot = delta < span(level + 1) || level + 1 < kLevels
+            ? (node.expiry >> (kBits * level)) & kMask
+            : ((now_ >> (kBits * level)) + kMask) & kMask; // beyond the wheel: revisit at the last slot
+        node.bucket = static_cast<uint16_t>(level * kSlots + slot);
+        node.prev = kNone;
+        node.next = heads_[node.bucket];
+        if (node.next != kNone) nodes_[node.next].prev = i;
+        heads_[node.bucket] = i;
+        masks_[level] |= uint64_t(1) << slot;
+    }
+
+    void unlink(uint32_t i) {
+        Node& node = nodes_[i];
+        if (node.prev != kNone) {
+            nodes_[node.prev].next = node.next;
+        } else {
+            heads_[node.bucket] = node.next;
+            if (node.next == kNone) {
+                masks_[node.bucket / kSlots] &= ~(uint64_t(1) << (node.bucket % kSlots));
+            }
+        }
+        if (node.next != kNone) nodes_[node.next].prev = node.prev;
+    }
+
+    // Empties a slot and returns its first node
+    uint32_t detach(size_t level, uint64_t slot) {
+        uint32_t head = heads_[level * kSlots + slot];
+        heads_[level * kSlots + slot] = kNone;
+        masks_[level] &= ~(uint64_t(1) << slot);
+        return head;
+    }
+
+    // Earliest time after now_ at which some occupied slot comes round
+    uint64_t nextEvent() const {
+        uint64_t best = UINT64_MAX;
+        for (size_t level = 0; level < kLevels; ++level) {
+            if (!masks_[level]) continue;
+            uint64_t block = now_ >> (kBits * level);
+            // Rotate so bit k stands for the slot k + 1 blocks ahead
+            unsigned shift = static_cast<unsigned>((block + 1) & kMask);
+            uint64_t rotated = (masks_[level] >> shift) | (masks_[level] << ((kSlots - shift) & kMask));
+            uint64_t ahead = static_cast<uint64_t>(__builtin_ctzll(rotated)) + 1;
+            best = std::min(best, (block + ahead) << (kBits * level));
+        }
+        return best;
+    }
+
+    void cascade(size_t level) {
+        uint32_t i = detach(level, (now_ >> (kBits * level)) & kMask);
+        while (i != kNone) {
+            uint32_t next = nodes_[i].next;
+            place(i);
+            i = next;
+        }
+    }
+
+    template <typename OnExpire>
+    void expire(OnExpire& onExpire) {
+        uint32_t i = detach(0, now_ & kMask);
+        while (i != kNone) {
+            uint32_t next = nodes_[i].next;
+            const std::string& key = *nodes_[i].key;
+            onExpire(key);
+            release(i);
+            index_.erase(index_.find(key));
+            i = next;
+        }
+    }
+};
+
+} // namespace cachesim
@@ -0,0 +1,246 @@
+#include "trace_analyzer.hpp"
+#include "count_min_sketch.hpp"
+#include <algorithm>
+#include <limits>
+
+namespace cachesim {
+
+namespace {
+
+constexpr uint64_t kNever = std::numeric_limits<uint64_t>::max();
+
+size_t log2Floor(uint64_t value) {
+    return 63 - static_cast<size_t>(__builtin_clzll(value));
+}
+
+} // namespace
+
+TraceAnalyzer::TraceAnalyzer(const AnalyzerConfig& config) : config_(config) {
+    config_.topK = std::max<size_t>(config_.topK, 1);
+    config_.workingSetWindow = std::max<size_t>(config_.workingSetWindow, 1);
+    config_.maxSampledKeys = std::max<size_t>(config_.maxSampledKeys, 16);
+
+    sampled_.reserve(config_.maxSampledKeys + 1);
+    tree_.assign(4 * config_.maxSampledKeys + 1, 0);
+    distance_.assign(kDistanceBuckets, 0.0);
+    working_set_.reserve(kMaxWindows);
+
+    size_t counters = counterLimit();
+    counters_.reserve(counters);
+    heap_.reserve(counters);
+    heap_pos_.reserve(counters);
+    counter_index_.reserve(counters);
+}
+
+void TraceAnalyzer::observe(const TraceOp& op) {
+    if (op.kind == TraceOp::Kind::DEL) {
+        return; // not an access
+    }
+    ++ops_;
+
+    uint32_t hash = static_cast<uint32_t>(FrequencySketch::hashKey(op.key)) & (kHashSpace - 1);
+    if (hash < threshold_) {
+        sample(op.key, hash);
+    }
+    countHot(op.key);
+
+    if (++ops_in_window_ == config_.workingSetWindow) {
+        closeWindow();
+    }
+}
+
+void TraceAnalyzer::sample(const std::string& key, uint32_t hash) {
+    if (time_ + 1 >= tree_.size()) {
+        compactTree();
+    }
+
+    double weight = 1.0 / rate();
+    auto [it, inserted] = sampled_.try_emplace(key);
+    SampledKey& entry = it->second;
+
+    if (inserted) {
+        entry = SampledKey{hash, 1, 0, kNever};
+        cold_ += weight;
+        by_hash_.emplace(hash, &it->first);
+    } else {
+        // Distinct sampled keys touched since the last reference, scaled up
+        uint64_t between = treePrefix(time_) - treePrefix(entry.lastTime + 1);
+        double scaled = double(between) * weight;
+        size_t bucket = scaled < 1.0 ? 0 : 1 + log2Floor(static_cast<uint64_t>(scaled));
+        distance_[std::min(bucket, kDistanceBuckets - 1)] += weight;
+        treeAdd(entry.lastTime, -1);
+        ++entry.count;
+    }
+
+    if (entry.lastWindow != window_) {
+        entry.lastWindow = window_;
+        window_distinct_ += weight;
+    }
+    treeAdd(time_, 1);
+    entry.lastTime = time_++;
+
+    if (inserted && sampled_.size() > config_.maxSampledKeys) {
+        shrinkSample();
+    }
+}
+
+// SHARDS-adj: lower the threshold to the largest sampled hash and drop
+// every key at that hash, so the sample stays within maxSampledKeys
+void TraceAnalyzer::shrinkSample() {
+    uint32_t top = by_hash_.top().first;
+    while (!by_hash_.empty() && by_hash_.top().first == top) {
+        const std::string* key = by_hash_.top().second;
+        by_hash_.pop();
+        auto it = sampled_.find(*key);
+        treeAdd(it->second.lastTime, -1);
+        sampled_.erase(it);
+    }
+    threshold_ = top;
+}
+
+void TraceAnalyzer::closeWindow() {
+    if (window_ % window_stride_ == 0) {
+        working_set_.push_back(window_distinct_);
+        if (working_set_.size() == kMaxWindows) {
+            // Keep every other sample and double the stride
+            for (size_t i = 0; i < kMaxWindows / 2; ++i) {
+                working_set_[i] = working_set_[2 * i];
+            }
+            working_set_.resize(kMaxWindows / 2);
+            window_stride_ *= 2;
+        }
+    }
+    ++window_;
+    ops_in_window_ = 0;
+    window_distinct_ = 0;
+}
+
+void TraceAnalyzer::countHot(const std::string& key) {
+    auto it = counter_index_.find(key);
+    if (it != counter_index_.end()) {
+        ++counters_[it->second].count;
+        siftDown(heap_pos_[it->second]);
+        return;
+    }
+
+    if (counters_.size() < counterLimit()) {
+        size_t index = counters_.size();
+        counters_.push_back(Counter{key, 1, 0});
+        counter_index_.emplace(key, index);
+        heap_.push_back(index);
+        heap_pos_.push_back(heap_.size() - 1);
+        siftUp(heap_.size() - 1);
+        return;
+    }
+
+    // Replace the minimum counter; its count becomes the newcomer's error
+    size_t index = heap_[0];
+    Counter& victim = counters_[index];
+    counter_index_.erase(victim.key);
+    victim.key = key;
+    victim.error = victim.count;
+    ++victim.count;
+    counter_index_.emplace(key, index);
+    siftDown(0);
+}
+
+void TraceAnalyzer::siftUp(size_t slot) {
+    while (slot > 0) {
+        size_t parent = (slot - 1) / 2;
+        if (counters_[heap_[parent]].count <= counters_[heap_[slot]].count) break;
+        std::swap(heap_[parent], heap_[slot]);
+        heap_pos_[heap_[parent]] = parent;
+        heap_pos_[heap_[slot]] = slot;
+        slot = parent;
+    }
+}
+
+void TraceAnalyzer::siftDown(size_t slot) {
+    for (;;) {
+        size_t smallest = slot;
+        for (size_t child = 2 * slot + 1; child <= 2 * slot + 2 && child < heap_.size(); ++child) {
+            if (counters_[heap_[child]].count < counters_[heap_[smallest]].count) {
+                smallest = child;
+            }
+        }
+        if (smallest == slot) break;
+        std::swap(heap_[smallest], heap_[slot]);
+        heap_pos_[heap_[smallest]] = smallest;
+        heap_pos_[heap_[slot]] = slot;
+        slot = smallest;
+    }
+}
+
+void TraceAnalyzer::treeAdd(uint64_t pos, int delta) {
+    for (uint64_t i = pos + 1; i < tree_.size(); i += i & (~i + 1)) {
+        tree_[i] += delta;
+    }
+}
+
+uint64_t TraceAnalyzer::treePrefix(uint64_t pos) const {
+    uint64_t sum = 0;
+    for (uint64_t i = pos; i > 0; i -= i & (~i + 1)) {
+        sum += tree_[i];
+    }
+    return sum;
+}
+
+// Renumber the live last-access times 0..n-1 (order preserved) and rebuild,
+// so the tree never needs more than a few slots per sampled key
+void TraceAnalyzer::compactTree() {
+    std::vector<SampledKey*> live;
+    live.reserve(sampled_.size());
+    for (auto& [key, entry] : sampled_) {
+        live.push_back(&entry);
+    }
+    std::sort(live.begin(), live.end(),
+              [](const SampledKey* a, const SampledKey* b) { return a->lastTime < b->lastTime; });
+
+    std::fill(tree_.begin(), tree_.end(), 0);
+    for (size_t i = 0; i < live.size(); ++i) {
+        live[i]->lastTime = i;
+        treeAdd(i, 1);
+    }
+    time_ = live.size();
+}
+
+TraceProfile TraceAnalyzer::profile() const {
+    TraceProfile profile;
+    profile.ops = ops_;
+    profile.samplingRate = rate();
+    profile.uniqueKeys = double(sampled_.size()) / rate();
+    profile.coldReferences = cold_;
+
+    size_t once = 0;
+    for (const auto& [key, entry] : sampled_) {
+        once += entry.count == 1;
+    }
+    profile.oneHitWonderRatio = sampled_.empty() ? 0.0 : double(once) / double(sampled_.size());
+
+    profile.reuseDistance = distance_;
+    while (!profile.reuseDistance.empty() && profile.reuseDistance.back() == 0.0) {
+        profile.reuseDistance.pop_back();
+    }
+
+    profile.workingSetWindow = config_.workingSetWindow;
+    profile.workingSetStride = window_stride_;
+    profile.workingSet = working_set_;
+    if (ops_in_window_ > 0 && window_ % window_stride_ == 0) {
+        profile.workingSet.push_back(window_distinct_); // trailing partial window
+    }
+
+    std::vector<const Counter*> hot;
+    hot.reserve(counters_.size());
+    for (const auto& counter : counters_) {
+        hot.push_back(&counter);
+    }
+    std::sort(hot.begin(), hot.end(),
+              [](const Counter* a, const Counter* b) { return a->count > b->count; });
+    for (size_t i = 0; i < hot.size() && i < config_.topK; ++i) {
+        profile.topKeys.push_back(HotKey{hot[i]->key, hot[i]->count, hot[i]->error});
+    }
+
+    return profile;
+}
+
+} // namespace cachesim
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "../include/types.hpp"
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+namespace cachesim {
+
+struct AnalyzerConfig {
+    size_t topK = 10;
+    size_t workingSetWindow = 1000; // ops per working-set window
+    size_t maxSampledKeys = 8192;   // bound on keys tracked for reuse distance
+};
+
+struct HotKey {
+    std::string key;
+    uint64_t count; // Space-Saving estimate (never below the true count)
+    uint64_t error; // count - error is a guaranteed lower bound
+};
+
+// Workload characterization from one pass over a trace. Counts derived from
+// sampled keys are scaled up by 1 / samplingRate.
+struct TraceProfile {
+    uint64_t ops = 0;
+    double samplingRate = 1.0;
+    double uniqueKeys = 0;        // estimated distinct keys
+    double oneHitWonderRatio = 0; // fraction of distinct keys referenced exactly once
+    double coldReferences = 0;    // first references (infinite reuse distance)
+
+    // reuseDistance[0] = re-reference with no other key in between;
+    // reuseDistance[b] = distance in [2^(b-1), 2^b) distinct keys
+    std::vector<double> reuseDistance;
+
+    // Distinct keys in each workingSetWindow-op window. When 1024 samples
+    // exist only every other one is kept and the stride doubles.
+    size_t workingSetWindow = 0;
+    size_t workingSetStride = 1;
+    std::vector<double> workingSet;
+
+    std::vector<HotKey> topKeys; // hottest first
+};
+
+// Streams TraceOps into bounded-memory sketches:
+//   - reuse distance via a Fenwick tree over last-access times of
+//     SHARDS-sampled keys (spatial hash sampling whose rate drops so at
+//     most maxSampledKeys keys are tracked)
+//   - working set per window and one-hit wonders from the same sample
+//   - top-K keys with a Space-Saving sketch of max(32 * topK, 256) counters;
+//     any count's error is at most ops / counters
+class TraceAnalyzer {
+public:
+    explicit TraceAnalyzer(const AnalyzerConfig& config = AnalyzerConfig{});
+
+    void observe(const TraceOp& op);
+    TraceProfile profile() const;
+
+private:
+    static constexpr uint32_t kHashSpace = 1u << 24;
+    static constexpr size_t kMaxWindows = 1024;
+    static constexpr size_t kDistanceBuckets = 64;
+
+    struct SampledKey {
+        uint32_t hash;
+        uint32_t count;
+        uint64_t lastTime;   // Fenwick position of the latest reference
+        uint64_t lastWindow; // working-set window of the latest reference
+    };
+
+    struct Counter {
+        std::string key;
+        uint64_t count;
+        uint64_t error;
+    };
+
+    AnalyzerConfig config_;
+    uint64_t ops_ = 0;
+
+    // SHARDS sample: keys whose hash is below threshold_
+    uint32_t threshold_ = kHashSpace;
+    std::unordered_map<std::string, SampledKey> sampled_;
+    std::priority_queue<std::pair<uint32_t, const std::string*>> by_hash_; // largest hash on top
+
+    // Fenwick tree marking the last-access time of each sampled key
+    std::vector<uint32_t> tree_;
+    uint64_t time_ = 0;
+
+    std::vector<double> distance_;
+    double cold_ = 0;
+
+    uint64_t window_ = 0;
+    uint64_t ops_in_window_ = 0;
+    double window_distinct_ = 0;
+    size_t window_stride_ = 1;
+    std::vector<double> working_set_;
+
+    // Space-Saving counters kept in a min-heap on count
+    std::vector<Counter> counters_;
+    std::vector<size_t> heap_;     // counter indices
+    std::vector<size_t> heap_pos_; // counter index -> heap slot
+    std::unordered_map<std::string, size_t> counter_index_;
+
+    double rate() const { return double(threshold_) / double(kHashSpace); }
+    size_t counterLimit() const { return std::max<size_t>(32 * config_.topK, 256); }
+
+    void sample(const std::string& key, uint32_t hash);
+    void shrinkSample();
+    void closeWindow();
+    void countHot(const std::string& key);
+    void siftUp(size_t slot);
+    void siftDown(size_t slot);
+
+    void treeAdd(uint64_t pos, int delta);
+    uint64_t treePrefix(uint64_t pos) const; // marks in [0, pos)
+    void compactTree();
+};
+
+} // namespace cachesim
@@ -0,0 +1,375 @@
+#include "trace_importers.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string_view>
+
+#ifdef CACHESIM_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef CACHESIM_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+namespace cachesim {
+
+namespace {
+
+// ARC traces address 512-byte sectors
+constexpr uint64_t kArcBlockBytes = 512;
+
+// Windows FILETIME (100 ns ticks since 1601) of the Unix epoch
+constexpr uint64_t kFileTimeUnixEpoch = 116444736000000000ULL;
+
+class FileSource : public ByteSource {
+public:
+    explicit FileSource(std::FILE* file) : file_(file) {}
+    ~FileSource() override { std::fclose(file_); }
+
+    size_t read(char* buffer, size_t capacity) override {
+        return std::fread(buffer, 1, capacity, file_);
+    }
+
+private:
+    std::FILE* file_;
+};
+
+#ifdef CACHESIM_WITH_ZLIB
+class GzipSource : public ByteSource {
+public:
+    explicit GzipSource(const std::string& path) : file_(gzopen(path.c_str(), "rb")) {
+        if (!file_) {
+            throw std::runtime_error("Cannot open " + path);
+        }
+        gzbuffer(file_, 1 << 17);
+    }
+    ~GzipSource() override { gzclose(file_); }
+
+    size_t read(char* buffer, size_t capacity) override {
+        int n = gzread(file_, buffer, static_cast<unsigned>(capacity));
+        if (n < 0) {
+            int code = 0;
+            throw std::runtime_error(std::string("gzip: ") + gzerror(file_, &code));
+        }
+        return static_cast<size_t>(n);
+    }
+
+private:
+    gzFile file_;
+};
+#endif
+
+#ifdef CACHESIM_WITH_ZSTD
+class ZstdSource : public ByteSource {
+public:
+    explicit ZstdSource(std::FILE* file)
+        : file_(file), stream_(ZSTD_createDStream()), input_(ZSTD_DStreamInSize()) {
+        // The destructor won't run if we throw here, so release both by hand
+        if (!stream_) {
+            std::fclose(file_);
+            throw std::runtime_error("zstd: cannot create decompression stream");
+        }
+        size_t rc = ZSTD_initDStream(stream_);
+        if (ZSTD_isError(rc)) {
+            ZSTD_freeDStream(stream_);
+            std::fclose(file_);
+            throw std::runtime_error(std::string("zstd: ") + ZSTD_getErrorName(rc));
+        }
+    }
+    ~ZstdSource() override {
+        ZSTD_freeDStream(stream_);
+        std::fclose(file_);
+    }
+
+    size_t read(char* buffer, size_t capacity) override {
+        ZSTD_outBuffer out{buffer, capacity, 0};
+        while (out.pos == 0) {
+            bool eof = false;
+            if (in_.pos == in_.size) {
+                size_t n = std::fread(input_.data(), 1, input_.size(), file_);
+                eof = n == 0;
+                in_ = ZSTD_inBuffer{input_.data(), n, 0};
+            }
+            // At EOF the decoder may still hold output; drain it with empty input
+            size_t rc = ZSTD_decompressStream(stream_, &out, &in_);
+            if (ZSTD_isError(rc)) {
+                throw std::runtime_error(std::string("zstd: ") + ZSTD_getErrorName(rc));
+            }
+            if (eof && out.pos == 0) {
+                // No progress: done, unless the last frame never finished
+                if (rc != 0) {
+                    throw std::runtime_error("zstd: truncated frame");
+                }
+                break;
+            }
+        }
+        return out.pos;
+    }
+
+private:
+    std::FILE* file_;
+    ZSTD_DStream* stream_;
+    std::vector<char> input_;
+    ZSTD_inBuffer in_{nullptr, 0, 0};
+};
+#endif
+
+// Splits a line on `delimiter` into at most `maxFields` fields; returns the count
+size_t splitFields(std::string_view line, char delimiter, std::string_view* fields, size_t maxFields) {
+    size_t count = 0;
+    while (count < maxFields) {
+        size_t pos = line.find(delimiter);
+        fields[count++] = line.substr(0, pos);
+        if (pos == std::string_view::npos) break;
+        line.remove_prefix(pos + 1);
+    }
+    return count;
+}
+
+// Splits on runs of spaces/tabs
+size_t splitWhitespace(std::string_view line, std::string_view* fields, size_t maxFields) {
+    size_t count = 0;
+    size_t i = 0;
+    while (count < maxFields) {
+        while (i < line.size() && (line[i] == ' ' || line[i] == '\t')) ++i;
+        if (i == line.size()) break;
+        size_t start = i;
+        while (i < line.size() && line[i] != ' ' && line[i] != '\t') ++i;
+        fields[count++] = line.substr(start, i - start);
+    }
+    return count;
+}
+
+bool parseUnsigned(std::string_view text, uint64_t& value) {
+    auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return ec == std::errc() && end == text.data() + text.size();
+}
+
+// Records are little-endian on disk; both wasm and x86 hosts are too
+template <typename T>
+T loadLittleEndian(const char* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+TraceOp makeOp(TraceOp::Kind kind, std::string key, uint64_t size, uint64_t timestamp) {
+    TraceOp op{kind, std::move(key), ""};
+    op.size = size;
+    op.timestamp = timestamp;
+    op.fill = kind == TraceOp::Kind::GET;
+    return op;
+}
+
+} // namespace
+
+TraceFormat traceFormatFromName(const std::string& name) {
+    if (name == "arc") return TraceFormat::ARC;
+    if (name == "msr") return TraceFormat::MSR;
+    if (name == "twitter") return TraceFormat::Twitter;
+    if (name == "oracle") return TraceFormat::OracleGeneral;
+    throw std::runtime_error("Unknown trace format: " + name + " (expected arc, msr, twitter or oracle)");
+}
+
+std::unique_ptr<ByteSource> openTraceFile(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        throw std::runtime_error("Cannot open " + path);
+    }
+
+    unsigned char magic[4] = {0, 0, 0, 0};
+    size_t n = std::fread(magic, 1, sizeof(magic), file);
+    std::rewind(file);
+
+    if (n >= 2 && magic[0] == 0x1f && magic[1] == 0x8b) {
+        std::fclose(file);
+#ifdef CACHESIM_WITH_ZLIB
+        return std::make_unique<GzipSource>(path);
+#else
+        throw std::runtime_error(path + " is gzip-compressed; rebuild with -DCACHESIM_WITH_ZLIB -lz");
+#endif
+    }
+    if (n == 4 && magic[0] == 0x28 && magic[1] == 0xb5 && magic[2] == 0x2f && magic[3] == 0xfd) {
+#ifdef CACHESIM_WITH_ZSTD
+        return std::make_unique<ZstdSource>(file);
+#else
+        std::fclose(file);
+        throw std::runtime_error(path + " is zstd-compressed; rebuild with -DCACHESIM_WITH_ZSTD -lzstd");
+#endif
+    }
+    return std::make_unique<FileSource>(file);
+}
+
+TraceImporter::TraceImporter(std::unique_ptr<ByteSource> source, TraceFormat format, size_t chunkBytes)
+    : source_(std::move(source)), format_(format),
+      buffer_(std::max(chunkBytes, kOracleRecordBytes)) {}
+
+bool TraceImporter::next(std::vector<TraceOp>& out, size_t maxOps) {
+    out.clear();
+    while (out.size() < maxOps) {
+        if (arc_remaining_ > 0) {
+            // Finish expanding the current ARC line
+            out.push_back(makeOp(TraceOp::Kind::GET, std::to_string(arc_next_block_++), kArcBlockBytes, 0));
+            --arc_remaining_;
+            continue;
+        }
+
+        if (format_ == TraceFormat::OracleGeneral) {
+            if (end_ - begin_ < kOracleRecordBytes && !fill()) {
+                if (end_ > begin_) {
+                    addError("Truncated record at end of trace (" + std::to_string(end_ - begin_) + " bytes)");
+                    begin_ = end_;
+                }
+                break;
+            }
+            if (end_ - begin_ >= kOracleRecordBytes) {
+                decodeOracleRecord(buffer_.data() + begin_, out);
+                begin_ += kOracleRecordBytes;
+            }
+            continue;
+        }
+
+        const char* line;
+        size_t length;
+        if (!nextLine(line, length)) break;
+        decodeLine(line, length, out);
+    }
+    return !out.empty();
+}
+
+bool TraceImporter::fill() {
+    if (eof_) {
+        return false;
+    }
+    // Keep the unread tail and top the buffer up behind it
+    if (begin_ > 0) {
+        std::memmove(buffer_.data(), buffer_.data() + begin_, end_ - begin_);
+        end_ -= begin_;
+        begin_ = 0;
+    }
+    if (end_ == buffer_.size()) {
+        throw std::runtime_error("Trace record is longer than the " + std::to_string(buffer_.size()) +
+                                 "-byte read buffer");
+    }
+    size_t n = source_->read(buffer_.data() + end_, buffer_.size() - end_);
+    if (n == 0) {
+        eof_ = true;
+        return false;
+    }
+    end_ += n;
+    return true;
+}
+
+bool TraceImporter::nextLine(const char*& line, size_t& length) {
+    for (;;) {
+        const char* start = buffer_.data() + begin_;
+        const void* newline = std::memchr(start, '\n', end_ - begin_);
+        if (newline) {
+            line = start;
+            length = static_cast<const char*>(newline) - start;
+            begin_ += length + 1;
+            return true;
+        }
+        if (!fill()) {
+            if (begin_ == end_) {
+                return false;
+            }
+            // Last line without a trailing newline
+            line = buffer_.data() + begin_;
+            length = end_ - begin_;
+            begin_ = end_;
+            return true;
+        }
+    }
+}
+
+void TraceImporter::decodeLine(const char* data, size_t length, std::vector<TraceOp>& out) {
+    std::string_view line(data, length);
+    if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+    }
+    if (line.empty() || line[0] == '#') {
+        return;
+    }
+    ++records_;
+
+    std::string_view fields[7];
+    switch (format_) {
+    case TraceFormat::ARC: {
+        uint64_t start, count;
+        if (splitWhitespace(line, fields, 4) < 2 || !parseUnsigned(fields[0], start) ||
+            !parseUnsigned(fields[1], count)) {
+            addError("Record " + std::to_string(records_) + ": expected '<start> <count> ...'");
+            return;
+        }
+        arc_next_block_ = start;
+        arc_remaining_ = count; // expanded by next()
+        return;
+    }
+    case TraceFormat::MSR: {
+        uint64_t filetime, offset, size;
+        if (splitFields(line, ',', fields, 7) < 6 || !parseUnsigned(fields[0], filetime) ||
+            !parseUnsigned(fields[4], offset) || !parseUnsigned(fields[5], size)) {
+            addError("Record " + std::to_string(records_) + ": expected MSR CSV");
+            return;
+        }
+        // One file per volume, so the byte offset identifies the block
+        uint64_t seconds = filetime > kFileTimeUnixEpoch ? (filetime - kFileTimeUnixEpoch) / 10000000 : 0;
+        bool write = fields[3] == "Write" || fields[3] == "write";
+        out.push_back(makeOp(write ? TraceOp::Kind::PUT : TraceOp::Kind::GET,
+                             std::to_string(offset), size, seconds));
+        return;
+    }
+    case TraceFormat::Twitter: {
+        uint64_t timestamp, keySize, valueSize;
+        size_t count = splitFields(line, ',', fields, 7);
+        if (count < 6 || !parseUnsigned(fields[0], timestamp) ||
+            !parseUnsigned(fields[2], keySize) || !parseUnsigned(fields[3], valueSize)) {
+            addError("Record " + std::to_string(records_) + ": expected Twitter CSV");
+            return;
+        }
+        std::string_view op = fields[5];
+        TraceOp::Kind kind;
+        if (op == "get" || op == "gets") {
+            kind = TraceOp::Kind::GET;
+        } else if (op == "set" || op == "add" || op == "replace" || op == "cas" ||
+                   op == "append" || op == "prepend" || op == "incr" || op == "decr") {
+            kind = TraceOp::Kind::PUT;
+        } else if (op == "delete") {
+            kind = TraceOp::Kind::DEL;
+        } else {
+            return; // unknown ops have no replacement-policy effect
+        }
+        out.push_back(makeOp(kind, std::string(fields[1]), keySize + valueSize, timestamp));
+        // The TTL column (seconds, 0 = none) is optional
+        uint64_t ttl = 0;
+        if (count > 6 && parseUnsigned(fields[6], ttl)) {
+            out.back().ttl = ttl;
+        }
+        return;
+    }
+    case TraceFormat::OracleGeneral:
+        break; // binary, handled by decodeOracleRecord
+    }
+}
+
+void TraceImporter::decodeOracleRecord(const char* record, std::vector<TraceOp>& out) {
+    ++records_;
+    uint32_t clockTime = loadLittleEndian<uint32_t>(record);
+    uint64_t objectId = loadLittleEndian<uint64_t>(record + 4);
+    uint32_t objectSize = loadLittleEndian<uint32_t>(record + 12);
+    // record + 16: next access time (for offline-optimal policies), unused here
+    out.push_back(makeOp(TraceOp::Kind::GET, std::to_string(objectId), objectSize, clockTime));
+}
+
+void TraceImporter::addError(const std::string& message) {
+    if (errors_.size() < kMaxErrors) {
+        errors_.push_back(message);
+    } else if (errors_.size() == kMaxErrors) {
+        errors_.push_back("Too many malformed records; further errors suppressed");
+    }
+}
+
+} // namespace cachesim
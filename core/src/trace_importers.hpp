@@ -0,0 +1,78 @@
+#pragma once
+
+#include "../include/types.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace cachesim {
+
+// Public trace formats the importers understand
+enum class TraceFormat {
+    ARC,           // ARC paper block traces: "start count ignored requestNo" per line
+    MSR,           // MSR Cambridge CSV: Timestamp,Hostname,Disk,Type,Offset,Size,ResponseTime
+    Twitter,       // Twitter cache-trace CSV: ts,key,keySize,valueSize,client,op,ttl
+    OracleGeneral, // libCacheSim binary: packed {u32 time, u64 id, u32 size, i64 next} records
+};
+
+// Parses "arc", "msr", "twitter" or "oracle"; throws std::runtime_error otherwise
+TraceFormat traceFormatFromName(const std::string& name);
+
+// A pull-based stream of raw bytes
+class ByteSource {
+public:
+    virtual ~ByteSource() = default;
+
+    // Reads up to `capacity` bytes; returns 0 at end of stream
+    virtual size_t read(char* buffer, size_t capacity) = 0;
+};
+
+// Opens a local file, transparently decompressing gzip (built with
+// CACHESIM_WITH_ZLIB) or zstd (built with CACHESIM_WITH_ZSTD) by magic bytes
+std::unique_ptr<ByteSource> openTraceFile(const std::string& path);
+
+// Decodes a trace chunk by chunk. Memory is one read buffer plus the batch
+// the caller asks for, whatever the file size. Keys are object/block IDs in
+// decimal (Twitter keys are kept as-is); reads become demand-fill GETs and
+// writes become PUTs, both carrying the object size and timestamp (and the
+// TTL, for Twitter traces). Twitter deletes become DELs.
+class TraceImporter {
+public:
+    static constexpr size_t kDefaultChunkBytes = 1 << 20;
+
+    TraceImporter(std::unique_ptr<ByteSource> source, TraceFormat format,
+                  size_t chunkBytes = kDefaultChunkBytes);
+
+    // Replaces `out` with up to `maxOps` operations; returns false once the
+    // trace is exhausted and nothing was decoded
+    bool next(std::vector<TraceOp>& out, size_t maxOps);
+
+    // Malformed records are skipped and reported here
+    const std::vector<std::string>& errors() const { return errors_; }
+    uint64_t recordsRead() const { return records_; }
+
+private:
+    static constexpr size_t kOracleRecordBytes = 24;
+    static constexpr size_t kMaxErrors = 100;
+
+    std::unique_ptr<ByteSource> source_;
+    TraceFormat format_;
+    std::vector<char> buffer_;
+    size_t begin_ = 0; // unread bytes are buffer_[begin_, end_)
+    size_t end_ = 0;
+    bool eof_ = false;
+    uint64_t records_ = 0;
+    std::vector<std::string> errors_;
+
+    // ARC lines expand to one reference per block; a line may span batches
+    uint64_t arc_next_block_ = 0;
+    uint64_t arc_remaining_ = 0;
+
+    bool fill();
+    bool nextLine(const char*& line, size_t& length);
+    void decodeLine(const char* line, size_t length, std::vector<TraceOp>& out);
+    void decodeOracleRecord(const char* record, std::vector<TraceOp>& out);
+    void addError(const std::string& message);
+};
+
+} // namespace cachesim
@@ -1,21 +1,199 @@
 #include "trace_parser.hpp"
 #include <sstream>
 #include <algorithm>
+#include <array>
 #include <cctype>
 #include <cstdio> // Added for printf
+#include <cstring>
 
 namespace cachesim {
 
-ParseResult TraceParser::parse(const std::string& traceText) {
+namespace {
+
+enum ByteClass : uint8_t { kOther = 0, kDigit = 1, kSpace = 2 };
+
+constexpr std::array<uint8_t, 256> makeByteClasses() {
+    std::array<uint8_t, 256> table{};
+    for (int c = '0'; c <= '9'; ++c) table[c] = kDigit;
+    table[' '] = table['\t'] = table['\r'] = table['\n'] = table[','] = kSpace;
+    return table;
+}
+
+constexpr std::array<uint8_t, 256> kByteClass = makeByteClasses();
+
+constexpr uint64_t kPow10[9] = {1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000};
+
+// The SWAR digit scanner reads 8 bytes as one little-endian word
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+constexpr bool kSwar = true;
+#else
+constexpr bool kSwar = false;
+#endif
+
+// Number of leading ASCII digits in an 8-byte chunk. A byte is a digit iff
+// its high nibble is 3 both before and after adding 6; carries only move
+// upward, so bytes below the first non-digit are classified exactly.
+inline size_t leadingDigits(uint64_t chunk) {
+    uint64_t t = (chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+                 (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4);
+    uint64_t x = t ^ 0x3333333333333333ULL;
+    return x ? static_cast<size_t>(__builtin_ctzll(x)) / 8 : 8;
+}
+
+// Value of the first n (1..8) digits of a chunk: shift them to the top so
+// the low bytes act as leading zeros, then combine pairs, quads and halves
+inline uint64_t digitsValue(uint64_t chunk, size_t n) {
+    chunk -= 0x3030303030303030ULL;
+    chunk <<= 8 * (8 - n);
+    chunk = chunk * 10 + (chunk >> 8);
+    return (((chunk & 0x000000FF000000FFULL) * 0x000F424000000064ULL) +
+            (((chunk >> 16) & 0x000000FF000000FFULL) * 0x0000271000000001ULL)) >> 32;
+}
+
+inline bool isEscapedNewline(const char* data, size_t size, size_t i) {
+    return data[i] == '\\' && i + 1 < size && data[i + 1] == 'n';
+}
+
+} // namespace
+
+bool TraceParser::isNumericTrace(const std::string& traceText) {
+    const char* data = traceText.data();
+    size_t size = traceText.size();
+    size_t i = 0;
+    while (i < size) {
+        if (kByteClass[static_cast<unsigned char>(data[i])] == kSpace) {
+            ++i;
+        } else if (isEscapedNewline(data, size, i)) {
+            i += 2;
+        } else if (data[i] == '#') {
+            while (i < size && data[i] != '\n' && !isEscapedNewline(data, size, i)) ++i;
+        } else {
+            return kByteClass[static_cast<unsigned char>(data[i])] == kDigit;
+        }
+    }
+    return false;
+}
+
+NumericTrace TraceParser::parseNumeric(const char* data, size_t size) {
+    NumericTrace trace;
+    trace.keys.reserve(size / 4);
+    trace.writes.reserve(size / 4);
+    
+    size_t i = 0;
+    int lineNumber = 1;
+    auto skipToken = [&]() {
+        while (i < size && kByteClass[static_cast<unsigned char>(data[i])] != kSpace &&
+               !isEscapedNewline(data, size, i)) {
+            ++i;
+        }
+    };
+    
+    while (i < size) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if (kByteClass[c] == kSpace) {
+            lineNumber += c == '\n';
+            ++i;
+            continue;
+        }
+        if (isEscapedNewline(data, size, i)) {
+            ++lineNumber;
+            i += 2;
+            continue;
+        }
+        if (c == '#') {
+            while (i < size && data[i] != '\n' && !isEscapedNewline(data, size, i)) ++i;
+            continue;
+        }
+        
+        size_t start = i;
+        uint64_t value = 0;
+        bool ended = false;
+        if (kSwar) {
+            // Eight bytes per step; a token ends inside the chunk it started in
+            // unless it is longer than 8 digits
+            while (i + 8 <= size) {
+                uint64_t chunk;
+                std::memcpy(&chunk, data + i, 8);
+                size_t n = leadingDigits(chunk);
+                if (n > 0) {
+                    value = value * kPow10[n] + digitsValue(chunk, n);
+                    i += n;
+                }
+                if (n < 8) {
+                    ended = true;
+                    break;
+                }
+            }
+        }
+        if (!ended) {
+            while (i < size && kByteClass[static_cast<unsigned char>(data[i])] == kDigit) {
+                value = value * 10 + uint64_t(data[i] - '0');
+                ++i;
+            }
+        }
+        
+        size_t digits = i - start;
+        uint8_t write = 0;
+        if (i < size && (data[i] == 'w' || data[i] == 'W')) {
+            write = 1;
+            ++i;
+        } else if (i < size && (data[i] == 'r' || data[i] == 'R')) {
+            ++i;
+        }
+        
+        bool atBoundary = i == size || kByteClass[static_cast<unsigned char>(data[i])] == kSpace ||
+                          data[i] == '#' || isEscapedNewline(data, size, i);
+        if (digits == 0 || digits > 19 || !atBoundary) {
+            skipToken();
+            trace.errors.push_back("Line " + std::to_string(lineNumber) + ": " +
+                (digits > 19 ? "Key has more than 19 digits: " : "Invalid reference: ") +
+                std::string(data + start, i - start));
+            trace.success = false;
+            continue;
+        }
+        
+        trace.keys.push_back(value);
+        trace.writes.push_back(write);
+    }
+    
+    return trace;
+}
+
+ParseResult TraceParser::parse(const std::string& traceText,
+                               const std::function<void(const TraceOp&)>& onOp) {
     ParseResult result;
     result.success = true;
     
-    // First, replace escaped newlines with actual newlines
-    std::string processedText = traceText;
-    size_t pos = 0;
-    while ((pos = processedText.find("\\n", pos)) != std::string::npos) {
-        processedText.replace(pos, 2, "\n");
-        pos += 1; // Move past the newline we just inserted
+    if (isNumericTrace(traceText)) {
+        NumericTrace numeric = parseNumeric(traceText.data(), traceText.size());
+        result.errors = std::move(numeric.errors);
+        result.success = numeric.success;
+        result.operations.reserve(numeric.keys.size());
+        for (size_t i = 0; i < numeric.keys.size(); ++i) {
+            // Policies are string-keyed, so IDs are materialized here
+            TraceOp op{TraceOp::Kind::GET, std::to_string(numeric.keys[i]), ""};
+            if (numeric.writes[i]) {
+                op.kind = TraceOp::Kind::PUT;
+                op.value = op.key;
+            } else {
+                op.fill = true;
+            }
+            if (onOp) onOp(op);
+            result.operations.push_back(std::move(op));
+        }
+        return result;
+    }
+    
+    // First, replace escaped newlines with actual newlines (one linear pass)
+    std::string processedText;
+    processedText.reserve(traceText.size());
+    for (size_t pos = 0; pos < traceText.size(); ++pos) {
+        if (traceText[pos] == '\\' && pos + 1 < traceText.size() && traceText[pos + 1] == 'n') {
+            processedText += '\n';
+            ++pos;
+        } else {
+            processedText += traceText[pos];
+        }
     }
     
     // Manual line splitting on actual newlines
@@ -51,7 +229,8 @@ ParseResult TraceParser::parse(const std::string& traceText) {
         
         try {
             TraceOp op = parseLine(trimmedLine, lineNumber);
-            result.operations.push_back(op);
+            if (onOp) onOp(op);
+            result.operations.push_back(std::move(op));
         } catch (const std::exception& e) {
             result.errors.push_back("Line " + std::to_string(lineNumber) + ": " + e.what());
             result.success = false;
@@ -75,12 +254,19 @@ TraceOp TraceParser::parseLine(const std::string& line, int lineNumber) {
             throw std::runtime_error("GET requires a key");
         }
         
-        // Check for extra tokens
-        if (stream >> value) {
-            throw std::runtime_error("GET should not have a value");
+        TraceOp result{TraceOp::Kind::GET, key, ""};
+        
+        // Only attributes (e.g. size=512) may follow the key
+        while (stream >> value) {
+            if (!applyAttribute(value, result)) {
+                throw std::runtime_error("GET should not have a value");
+            }
+        }
+        if (result.ttl) {
+            throw std::runtime_error("ttl= only applies to PUT");
         }
         
-        return TraceOp{TraceOp::Kind::GET, key, ""};
+        return result;
         
     } else if (op == "PUT") {
         if (!(stream >> key)) {
@@ -91,17 +277,64 @@ TraceOp TraceParser::parseLine(const std::string& line, int lineNumber) {
         std::getline(stream, value);
         value = trim(value);
         
+        // Peel trailing attributes off the value
+        TraceOp result{TraceOp::Kind::PUT, key, ""};
+        size_t split;
+        while ((split = value.find_last_of(" \t")) != std::string::npos &&
+               applyAttribute(value.substr(split + 1), result)) {
+            value = trim(value.substr(0, split));
+        }
+        
         if (value.empty()) {
             throw std::runtime_error("PUT requires a value");
         }
         
-        return TraceOp{TraceOp::Kind::PUT, key, value};
+        result.value = value;
+        return result;
+        
+    } else if (op == "DEL") {
+        if (!(stream >> key)) {
+            throw std::runtime_error("DEL requires a key");
+        }
+        
+        TraceOp result{TraceOp::Kind::DEL, key, ""};
+        while (stream >> value) {
+            if (!applyAttribute(value, result)) {
+                throw std::runtime_error("DEL should not have a value");
+            }
+        }
+        if (result.ttl) {
+            throw std::runtime_error("ttl= only applies to PUT");
+        }
+        
+        return result;
         
     } else {
-        throw std::runtime_error("Unknown operation: " + op + " (expected GET or PUT)");
+        throw std::runtime_error("Unknown operation: " + op + " (expected GET, PUT or DEL)");
     }
 }
 
+// Recognizes "size=<bytes>", "ts=<seconds>" and "ttl=<seconds>"; returns false for anything else
+bool TraceParser::applyAttribute(const std::string& token, TraceOp& op) {
+    size_t eq = token.find('=');
+    if (eq == std::string::npos) {
+        return false;
+    }
+    
+    std::string name = token.substr(0, eq);
+    std::string number = token.substr(eq + 1);
+    uint64_t* field = name == "size" ? &op.size : name == "ts" ? &op.timestamp : name == "ttl" ? &op.ttl : nullptr;
+    if (!field) {
+        return false;
+    }
+    if (number.empty() || number.size() > 19 || number.find_first_not_of("0123456789") != std::string::npos) {
+        throw std::runtime_error("Invalid " + name + ": " + number);
+    }
+    
+    *field = std::stoull(number);
+    return true;
+}
+
 std::string TraceParser::trim(const std::string& str) {
     size_t start = str.find_first_not_of(" \t\r\n");
     if (start == std::string::npos) return "";
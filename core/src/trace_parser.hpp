@@ -1,6 +1,7 @@
 #pragma once
 
 #include "../include/types.hpp"
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -12,12 +13,36 @@ struct ParseResult {
     bool success;
 };
 
+// A numeric reference string as parallel arrays: key IDs and a write flag
+// per reference (set by a "w" suffix, e.g. "42w")
+struct NumericTrace {
+    std::vector<uint64_t> keys;
+    std::vector<uint8_t> writes;
+    std::vector<std::string> errors;
+    bool success = true;
+};
+
 class TraceParser {
 public:
-    static ParseResult parse(const std::string& traceText);
+    // Accepts GET/PUT/DEL traces, or numeric reference strings ("1 2 3 1 4"),
+    // detected from the first token. Numeric references become demand-fill
+    // GETs (a miss inserts the key); a "w" suffix makes one a PUT.
+    // GET/PUT/DEL lines may end in size=<bytes>, ts=<seconds> and (PUT only)
+    // ttl=<seconds> attributes.
+    // `onOp`, if set, sees each operation as it is parsed (e.g. TraceAnalyzer).
+    static ParseResult parse(const std::string& traceText,
+                             const std::function<void(const TraceOp&)>& onOp = nullptr);
+    
+    // Scans whitespace-separated unsigned integers with an optional r/w
+    // suffix straight into key IDs, without building any strings.
+    // '#' starts a comment that runs to the end of the line.
+    static NumericTrace parseNumeric(const char* data, size_t size);
+    
+    static bool isNumericTrace(const std::string& traceText);
     
 private:
     static TraceOp parseLine(const std::string& line, int lineNumber);
+    static bool applyAttribute(const std::string& token, TraceOp& op);
     static std::string trim(const std::string& str);
     static bool isComment(const std::string& line);
     static bool isEmpty(const std::string& line);
@@ -0,0 +1,228 @@
+#pragma once
+
+#include "../include/types.hpp"
+#include "count_min_sketch.hpp"
+#include <algorithm>
+#include <list>
+#include <unordered_map>
+
+namespace cachesim {
+
+// W-TinyLFU: a small LRU window (~1% of capacity) in front of a segmented
+// LRU main region (20% probation, 80% protected). Keys leaving the window
+// must beat the probation victim's estimated frequency to be admitted.
+class WTinyLFUPolicy : public IPolicy {
+private:
+    enum class Segment { Window, Probation, Protected };
+
+    struct Entry {
+        std::string value;
+        Segment segment;
+        std::list<std::string>::iterator pos;
+    };
+
+    size_t capacity_;
+    size_t window_capacity_;
+    size_t main_capacity_;
+    size_t protected_capacity_;
+
+    // MRU -> ... -> LRU
+    std::list<std::string> window_;
+    std::list<std::string> probation_;
+    std::list<std::string> protected_;
+    std::unordered_map<std::string, Entry> entries_;
+
+    FrequencySketch sketch_;
+    std::string last_miss_; // a put() of this key fills that miss and is not counted again
+    uint64_t hit_path_writes_ = 0;
+
+    std::list<std::string>& listFor(Segment segment) {
+        switch (segment) {
+            case Segment::Window: return window_;
+            case Segment::Probation: return probation_;
+            default: return protected_;
+        }
+    }
+
+    void moveTo(Entry& entry, Segment segment) {
+        std::list<std::string>& from = listFor(entry.segment);
+        std::list<std::string>& to = listFor(segment);
+        to.splice(to.begin(), from, entry.pos);
+        entry.segment = segment;
+    }
+
+    // Returns true if any list was relinked
+    bool onHit(Entry& entry) {
+        if (entry.segment == Segment::Probation) {
+            // Promote; demote protected LRU back to probation if over quota
+            moveTo(entry, Segment::Protected);
+            if (protected_.size() > protected_capacity_) {
+                Entry& demoted = entries_.at(protected_.back());
+                moveTo(demoted, Segment::Probation);
+            }
+            return true;
+        }
+        std::list<std::string>& list = listFor(entry.segment);
+        if (entry.pos == list.begin()) {
+            return false;
+        }
+        list.splice(list.begin(), list, entry.pos);
+        return true;
+    }
+
+    void reindex() {
+        for (auto* list : {&window_, &probation_, &protected_}) {
+            for (auto it = list->begin(); it != list->end(); ++it) {
+                entries_.at(*it).pos = it;
+            }
+        }
+    }
+
+    std::string removeBack(std::list<std::string>& list) {
+        std::string key = list.back();
+        list.pop_back();
+        entries_.erase(key);
+        return key;
+    }
+
+public:
+    explicit WTinyLFUPolicy(size_t capacity)
+        : capacity_(capacity),
+          window_capacity_(std::max<size_t>(1, capacity / 100)),
+          main_capacity_(capacity > window_capacity_ ? capacity - window_capacity_ : 0),
+          protected_capacity_(main_capacity_ * 4 / 5),
+          sketch_(capacity) {
+        entries_.reserve(capacity_);
+    }
+
+    bool get(const std::string& key, std::string& outVal) override {
+        sketch_.increment(key);
+
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            last_miss_ = key;
+            return false; // miss
+        }
+
+        last_miss_.clear();
+        outVal = it->second.value;
+        if (onHit(it->second)) {
+            ++hit_path_writes_;
+        }
+        return true; // hit
+    }
+
+    std::optional<std::string> put(const std::string& key, const std::string& val) override {
+        // A demand fill right after its miss is the same access
+        if (last_miss_.empty() || key != last_miss_) {
+            sketch_.increment(key);
+        }
+        last_miss_.clear();
+
+        auto it = entries_.find(key);
+        if (it != entries_.end()) {
+            // Key exists - update value and treat as access
+            it->second.value = val;
+            onHit(it->second);
+            return std::nullopt;
+        }
+
+        // New keys always enter the window
+        window_.push_front(key);
+        entries_[key] = Entry{val, Segment::Window, window_.begin()};
+
+        if (window_.size() <= window_capacity_) {
+            return std::nullopt;
+        }
+
+        // Window overflow - its LRU key becomes an admission candidate
+        Entry& candidate = entries_.at(window_.back());
+        if (main_capacity_ == 0) {
+            return removeBack(window_);
+        }
+        if (probation_.size() + protected_.size() < main_capacity_) {
+            moveTo(candidate, Segment::Probation);
+            return std::nullopt;
+        }
+
+        std::list<std::string>& victims = probation_.empty() ? protected_ : probation_;
+        if (sketch_.estimate(window_.back()) > sketch_.estimate(victims.back())) {
+            std::string evicted = removeBack(victims);
+            moveTo(candidate, Segment::Probation);
+            return evicted;
+        }
+        return removeBack(window_);
+    }
+
+    std::optional<std::string> evict() override {
+        // Byte-bounded runs stay below the entry capacity, so keep the window
+        // at ~1% of the residents rather than of the capacity
+        size_t window_target = std::max<size_t>(1, entries_.size() / 100);
+        while (window_.size() > window_target) {
+            moveTo(entries_.at(window_.back()), Segment::Probation);
+        }
+
+        std::list<std::string>& victims = probation_.empty() ? protected_ : probation_;
+        if (window_.empty() && victims.empty()) {
+            return std::nullopt;
+        }
+        if (window_.empty()) return removeBack(victims);
+        if (victims.empty()) return removeBack(window_);
+
+        // Same contest as admission: the less popular of window LRU and main victim goes
+        if (sketch_.estimate(window_.back()) > sketch_.estimate(victims.back())) {
+            return removeBack(victims);
+        }
+        return removeBack(window_);
+    }
+
+    bool erase(const std::string& key) override {
+        // The sketch keeps its counts; only residency is dropped
+        auto it = entries_.find(key);
+        if (it == entries_.end()) {
+            return false;
+        }
+        listFor(it->second.segment).erase(it->second.pos);
+        entries_.erase(it);
+        return true;
+    }
+
+    std::vector<std::pair<std::string, std::string>> snapshot() const override {
+        std::vector<std::pair<std::string, std::string>> result;
+        result.reserve(entries_.size());
+
+        // Window, then protected, then probation
+        for (const auto* list : {&window_, &protected_, &probation_}) {
+            for (const auto& key : *list) {
+                result.emplace_back(key, entries_.at(key).value);
+            }
+        }
+
+        return result;
+    }
+
+    void metaForUI(Step& s) const override {
+        for (const auto& [key, entry] : entries_) {
+            s.freq[key] = sketch_.estimate(key);
+        }
+    }
+
+    bool isCacheHit(const std::string& key) const override {
+        return entries_.find(key) != entries_.end();
+    }
+
+    uint64_t hitPathWrites() const override { return hit_path_writes_; }
+
+    int keyFrequency(const std::string& key) const override {
+        return sketch_.estimate(key);
+    }
+
+    std::unique_ptr<IPolicy> clone() const override {
+        // The implicit copy still points into our lists; re-point it at its own
+        auto copy = std::make_unique<WTinyLFUPolicy>(*this);
+        copy->reindex();
+        return copy;
+    }
+};
+
+} // namespace cachesim
@@ -0,0 +1,240 @@
+// Command-line replay of a trace file against one or more policies.
+//
+// Public trace formats (ARC, MSR Cambridge, Twitter, oracleGeneral) are
+// decoded in batches and applied to every policy as they arrive, so memory
+// stays bounded by cache state rather than trace length. gzip/zstd inputs
+// are decompressed on the fly when built with CACHESIM_WITH_ZLIB/ZSTD.
+//
+// Usage: cachesim_cli <trace> [--format text|arc|msr|twitter|oracle]
+//                     [--policies LRU,ARC,...] [--capacity N] [--byte-capacity B]
+//                     [--analyze] [--prefetch N] [--step-log PATH]
+// The default format is "text" (GET/PUT lines or a numeric reference string).
+// --analyze adds a workload profile (reuse distance, working set, one-hit
+// wonders, hottest keys) computed in the same pass. --prefetch N replays in
+// groups of N ops with their hash probes prefetched (LRU, FIFO, ARC), which
+// speeds up caches far larger than the CPU cache. --step-log PATH streams
+// every op's outcome to a columnar step log (PATH.<policy> when replaying
+// several policies); read it back with step_log_inspect.
+
+#include "../core/src/policy_factory.hpp"
+#include "../core/src/simulator.hpp"
+#include "../core/src/step_log.hpp"
+#include "../core/src/trace_analyzer.hpp"
+#include "../core/src/trace_importers.hpp"
+#include "../core/src/trace_parser.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace cachesim;
+
+namespace {
+
+constexpr size_t kBatchOps = 1 << 16;
+
+struct Options {
+    std::string tracePath;
+    std::string format = "text";
+    std::vector<std::string> policies{"LRU"};
+    size_t capacity = 1000;
+    uint64_t byteCapacity = 0;
+    bool analyze = false;
+    size_t prefetch = 0;
+    std::string stepLog;
+};
+
+struct Replay {
+    std::string name;
+    std::unique_ptr<IPolicy> policy;
+    Stats stats;
+    ByteLedger ledger;
+    TimingWheel expiry;
+    std::unique_ptr<StepLogWriter> log;
+};
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+void applyBatch(const std::vector<TraceOp>& batch, std::vector<Replay>& replays, bool trackBytes,
+                size_t prefetch) {
+    for (auto& replay : replays) {
+        if (replay.log) {
+            // Per-op outcomes, so ops go one at a time (no prefetch groups)
+            ByteLedger* bytes = trackBytes ? &replay.ledger : nullptr;
+            std::optional<std::string> evicted;
+            for (const auto& op : batch) {
+                evicted.reset();
+                uint64_t ghosts = replay.stats.ghostHits;
+                bool hit = Simulator::applyOp(op, *replay.policy, replay.stats, evicted, bytes, &replay.expiry);
+                bool ghostHit = replay.stats.ghostHits != ghosts;
+                replay.log->append(op, hit && !ghostHit, ghostHit, evicted, replay.policy->gauges().arcP,
+                                   replay.policy->keyFrequency(op.key));
+            }
+            continue;
+        }
+        Simulator::applyBatch(batch.data(), batch.data() + batch.size(), *replay.policy, replay.stats,
+                              trackBytes ? &replay.ledger : nullptr, prefetch, &replay.expiry);
+    }
+}
+
+void closeLogs(std::vector<Replay>& replays) {
+    for (auto& replay : replays) {
+        if (replay.log) replay.log->close();
+    }
+}
+
+void report(const std::vector<Replay>& replays, uint64_t ops, bool trackBytes) {
+    std::printf("ops=%llu\n", (unsigned long long)ops);
+    std::printf("%-10s %12s %12s %8s %12s %12s", "policy", "hits", "misses", "hit", "evictions", "expirations");
+    if (trackBytes) std::printf(" %8s", "byteHit");
+    std::printf("\n");
+    for (const auto& replay : replays) {
+        const Stats& s = replay.stats;
+        std::printf("%-10s %12llu %12llu %8.4f %12llu %12llu", replay.name.c_str(),
+            (unsigned long long)s.hits, (unsigned long long)s.misses, s.hitRatio(),
+            (unsigned long long)s.evictions, (unsigned long long)s.expirations);
+        if (trackBytes) std::printf(" %8.4f", s.byteHitRatio());
+        std::printf("\n");
+    }
+}
+
+void reportProfile(const TraceProfile& profile) {
+    std::printf("\nworkload profile (sampling rate %.4f)\n", profile.samplingRate);
+    std::printf("  unique keys        %.0f\n", profile.uniqueKeys);
+    std::printf("  one-hit wonders    %.4f\n", profile.oneHitWonderRatio);
+    std::printf("  cold references    %.0f\n", profile.coldReferences);
+    std::printf("  reuse distance     ");
+    for (size_t b = 0; b < profile.reuseDistance.size(); ++b) {
+        // Bucket b > 0 holds distances below 2^b
+        if (b == 0) {
+            std::printf("0:%.0f", profile.reuseDistance[b]);
+        } else {
+            std::printf(" <%llu:%.0f", 1ULL << b, profile.reuseDistance[b]);
+        }
+    }
+    std::printf("\n  working set/%zu ops ", profile.workingSetWindow);
+    double peak = 0, sum = 0;
+    for (double size : profile.workingSet) {
+        peak = std::max(peak, size);
+        sum += size;
+    }
+    std::printf("mean %.0f, peak %.0f\n", profile.workingSet.empty() ? 0.0 : sum / profile.workingSet.size(), peak);
+    std::printf("  hottest keys      ");
+    for (const auto& hot : profile.topKeys) {
+        std::printf(" %s:%llu", hot.key.c_str(), (unsigned long long)hot.count);
+    }
+    std::printf("\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--format" && i + 1 < argc) {
+            opt.format = argv[++i];
+        } else if (arg == "--policies" && i + 1 < argc) {
+            opt.policies = splitList(argv[++i]);
+        } else if (arg == "--capacity" && i + 1 < argc) {
+            opt.capacity = std::stoul(argv[++i]);
+        } else if (arg == "--byte-capacity" && i + 1 < argc) {
+            opt.byteCapacity = std::stoull(argv[++i]);
+        } else if (arg == "--analyze") {
+            opt.analyze = true;
+        } else if (arg == "--prefetch" && i + 1 < argc) {
+            opt.prefetch = std::stoul(argv[++i]);
+        } else if (arg == "--step-log" && i + 1 < argc) {
+            opt.stepLog = argv[++i];
+        } else if (!arg.empty() && arg[0] != '-') {
+            opt.tracePath = arg;
+        } else {
+            std::fprintf(stderr, "Unknown argument: %s\n", arg.c_str());
+            return 2;
+        }
+    }
+    if (opt.tracePath.empty()) {
+        std::fprintf(stderr, "Usage: cachesim_cli <trace> [--format text|arc|msr|twitter|oracle] "
+                             "[--policies LRU,ARC] [--capacity N] [--byte-capacity B] [--analyze] [--prefetch N] [--step-log PATH]\n");
+        return 2;
+    }
+
+    try {
+        std::vector<Replay> replays;
+        for (const auto& name : opt.policies) {
+            Replay replay;
+            replay.name = name;
+            replay.policy = createPolicy(name, opt.capacity);
+            replay.ledger.capacity = opt.byteCapacity;
+            if (!opt.stepLog.empty()) {
+                std::string path = opt.policies.size() == 1 ? opt.stepLog : opt.stepLog + "." + name;
+                replay.log = std::make_unique<StepLogWriter>(path);
+            }
+            replays.push_back(std::move(replay));
+        }
+
+        TraceAnalyzer analyzer;
+        uint64_t ops = 0;
+        if (opt.format == "text") {
+            // The text format is parsed whole, as in the browser
+            std::ifstream in(opt.tracePath);
+            if (!in) {
+                std::fprintf(stderr, "Cannot open %s\n", opt.tracePath.c_str());
+                return 1;
+            }
+            std::stringstream text;
+            text << in.rdbuf();
+            std::function<void(const TraceOp&)> onOp;
+            if (opt.analyze) {
+                onOp = [&](const TraceOp& op) { analyzer.observe(op); };
+            }
+            ParseResult parsed = TraceParser::parse(text.str(), onOp);
+            if (!parsed.success) {
+                for (const auto& error : parsed.errors) std::fprintf(stderr, "%s\n", error.c_str());
+                return 1;
+            }
+            bool trackBytes = opt.byteCapacity > 0;
+            for (const auto& op : parsed.operations) {
+                trackBytes = trackBytes || op.size > 0;
+            }
+            applyBatch(parsed.operations, replays, trackBytes, opt.prefetch);
+            closeLogs(replays);
+            report(replays, parsed.operations.size(), trackBytes);
+            if (opt.analyze) reportProfile(analyzer.profile());
+            return 0;
+        }
+
+        // Imported formats carry object sizes, so byte stats are always kept
+        TraceImporter importer(openTraceFile(opt.tracePath), traceFormatFromName(opt.format));
+        std::vector<TraceOp> batch;
+        batch.reserve(kBatchOps);
+        while (importer.next(batch, kBatchOps)) {
+            if (opt.analyze) {
+                for (const auto& op : batch) analyzer.observe(op);
+            }
+            applyBatch(batch, replays, true, opt.prefetch);
+            ops += batch.size();
+        }
+        for (const auto& error : importer.errors()) {
+            std::fprintf(stderr, "%s\n", error.c_str());
+        }
+        closeLogs(replays);
+        report(replays, ops, true);
+        if (opt.analyze) reportProfile(analyzer.profile());
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,203 @@
+// Multi-threaded replay harness for the concurrent cache engines.
+//
+// Drives ConcurrentLRUCache and ConcurrentClockCache from T threads over a
+// shared trace and reports throughput, latency percentiles and lock
+// contention as T scales. Each thread replays the whole trace starting at
+// its own offset; a GET miss is followed by a fill, as in a real cache.
+//
+// Usage: concurrent_replay [trace.txt] [--capacity N] [--threads 1,2,4,8]
+//                          [--stripes S] [--engine lru|clock|both]
+// Without a trace file a Zipf(0.99) workload over 100k keys is generated.
+
+#include "../core/src/concurrent_clock_cache.hpp"
+#include "../core/src/concurrent_lru_cache.hpp"
+#include "../core/src/trace_parser.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cachesim;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr size_t kLatencySampleEvery = 16;
+
+struct Options {
+    std::string tracePath;
+    size_t capacity = 10000;
+    size_t stripes = 64;
+    std::vector<size_t> threads{1, 2, 4, 8};
+    std::string engine = "both";
+};
+
+struct RunResult {
+    double seconds = 0;
+    uint64_t ops = 0;
+    std::vector<uint64_t> latenciesNs;
+    ConcurrentCacheStats stats;
+};
+
+std::vector<size_t> parseList(const std::string& text) {
+    std::vector<size_t> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) values.push_back(std::stoul(item));
+    }
+    return values;
+}
+
+std::vector<TraceOp> zipfTrace(size_t ops, size_t keys, double skew) {
+    std::vector<double> cdf(keys);
+    double sum = 0;
+    for (size_t i = 0; i < keys; ++i) {
+        sum += 1.0 / std::pow(double(i + 1), skew);
+        cdf[i] = sum;
+    }
+
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> uniform(0.0, sum);
+    std::vector<TraceOp> trace;
+    trace.reserve(ops);
+    for (size_t i = 0; i < ops; ++i) {
+        size_t rank = std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin();
+        trace.push_back(TraceOp{TraceOp::Kind::GET, "k" + std::to_string(rank), ""});
+    }
+    return trace;
+}
+
+template <typename Cache>
+RunResult replay(const std::vector<TraceOp>& trace, const Options& opt, size_t threadCount) {
+    Cache cache(opt.capacity, opt.stripes);
+    std::vector<std::vector<uint64_t>> latencies(threadCount);
+    std::vector<std::thread> threads;
+
+    auto start = Clock::now();
+    for (size_t t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&, t]() {
+            std::string value;
+            auto& samples = latencies[t];
+            samples.reserve(trace.size() / kLatencySampleEvery + 1);
+            size_t offset = trace.size() * t / threadCount;
+
+            for (size_t n = 0; n < trace.size(); ++n) {
+                const TraceOp& op = trace[(offset + n) % trace.size()];
+                bool sample = n % kLatencySampleEvery == 0;
+                auto opStart = sample ? Clock::now() : Clock::time_point{};
+
+                if (op.kind == TraceOp::Kind::GET) {
+                    if (!cache.get(op.key, value)) {
+                        cache.put(op.key, op.key); // demand fill
+                    }
+                } else if (op.kind == TraceOp::Kind::PUT) {
+                    cache.put(op.key, op.value);
+                } // the concurrent engines have no erase, so DELs are skipped
+
+                if (sample) {
+                    samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        Clock::now() - opStart).count());
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    RunResult result;
+    result.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    result.ops = uint64_t(trace.size()) * threadCount;
+    for (auto& samples : latencies) {
+        result.latenciesNs.insert(result.latenciesNs.end(), samples.begin(), samples.end());
+    }
+    std::sort(result.latenciesNs.begin(), result.latenciesNs.end());
+    result.stats = cache.stats();
+    return result;
+}
+
+uint64_t percentile(const std::vector<uint64_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t index = static_cast<size_t>(p * double(sorted.size() - 1));
+    return sorted[index];
+}
+
+void report(const char* engine, size_t threadCount, const RunResult& r) {
+    std::printf("%-6s %3zu %12.0f %9llu %9llu %9llu %8.4f %9.4f %8llu\n",
+        engine, threadCount, double(r.ops) / r.seconds,
+        (unsigned long long)percentile(r.latenciesNs, 0.50),
+        (unsigned long long)percentile(r.latenciesNs, 0.99),
+        (unsigned long long)percentile(r.latenciesNs, 0.999),
+        r.stats.hitRatio(), r.stats.contentionRatio(),
+        (unsigned long long)r.stats.drains);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--capacity" && i + 1 < argc) {
+            opt.capacity = std::stoul(argv[++i]);
+        } else if (arg == "--stripes" && i + 1 < argc) {
+            opt.stripes = std::stoul(argv[++i]);
+        } else if (arg == "--threads" && i + 1 < argc) {
+            opt.threads = parseList(argv[++i]);
+        } else if (arg == "--engine" && i + 1 < argc) {
+            opt.engine = argv[++i];
+        } else if (!arg.empty() && arg[0] != '-') {
+            opt.tracePath = arg;
+        } else {
+            std::fprintf(stderr, "Unknown argument: %s\n", arg.c_str());
+            return 2;
+        }
+    }
+
+    std::vector<TraceOp> trace;
+    if (opt.tracePath.empty()) {
+        trace = zipfTrace(1000000, 100000, 0.99);
+    } else {
+        std::ifstream in(opt.tracePath);
+        if (!in) {
+            std::fprintf(stderr, "Cannot open %s\n", opt.tracePath.c_str());
+            return 1;
+        }
+        std::stringstream text;
+        text << in.rdbuf();
+        ParseResult parsed = TraceParser::parse(text.str());
+        if (!parsed.success) {
+            for (const auto& error : parsed.errors) std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        trace = std::move(parsed.operations);
+    }
+    if (trace.empty()) {
+        std::fprintf(stderr, "Trace is empty\n");
+        return 1;
+    }
+
+    std::printf("ops/thread=%zu capacity=%zu stripes=%zu hw_threads=%u\n",
+        trace.size(), opt.capacity, opt.stripes, std::thread::hardware_concurrency());
+    std::printf("%-6s %3s %12s %9s %9s %9s %8s %9s %8s\n",
+        "engine", "T", "ops/s", "p50(ns)", "p99(ns)", "p999(ns)", "hit", "contended", "drains");
+
+    for (size_t threadCount : opt.threads) {
+        if (threadCount == 0) continue;
+        if (opt.engine == "lru" || opt.engine == "both") {
+            report("lru", threadCount, replay<ConcurrentLRUCache>(trace, opt, threadCount));
+        }
+        if (opt.engine == "clock" || opt.engine == "both") {
+            report("clock", threadCount, replay<ConcurrentClockCache>(trace, opt, threadCount));
+        }
+    }
+    return 0;
+}
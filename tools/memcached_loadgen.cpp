@@ -0,0 +1,442 @@
+// Closed-loop load generator for memcached_server.
+//
+// For each policy, starts memcached_server on a Unix socket (or targets an
+// already running server with --connect), opens C connections and replays
+// the trace on each, starting at its own offset. A GET that misses is
+// followed by a SET of the key (demand fill), as a look-aside cache client
+// would. Each connection sends --depth requests at a time and waits for
+// their replies before sending more, so offered load follows latency
+// ("closed loop"). Reports requests/s, p50/p99/p999 request latency, the hit
+// ratio clients saw and the server's eviction count.
+//
+// Usage: memcached_loadgen [trace.txt] [--server ./memcached_server] [--policies LRU,ARC]
+//                          [--capacity N] [--connections 4] [--depth 1] [--ops N]
+//                          [--value-size 100] [--connect HOST:PORT | --connect unix:PATH]
+// Without a trace file a Zipf(0.99) workload over 100k keys is generated.
+// Linux only.
+
+#include "../core/src/trace_parser.hpp"
+
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace cachesim;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Options {
+    std::string tracePath;
+    std::string server = "./memcached_server";
+    std::string connect; // empty = start a server per policy
+    std::vector<std::string> policies{"LRU", "ARC", "S3-FIFO", "W-TinyLFU"};
+    size_t capacity = 10000;
+    size_t connections = 4;
+    size_t depth = 1;
+    size_t ops = 0; // per connection; 0 = the whole trace
+    size_t valueSize = 100;
+};
+
+struct ConnectionResult {
+    uint64_t requests = 0, hits = 0, misses = 0;
+    std::vector<uint64_t> latenciesNs;
+};
+
+struct RunResult {
+    double seconds = 0;
+    uint64_t requests = 0, hits = 0, misses = 0;
+    uint64_t evictions = 0;
+    std::vector<uint64_t> latenciesNs;
+};
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+std::vector<TraceOp> zipfTrace(size_t ops, size_t keys, double skew) {
+    std::vector<double> cdf(keys);
+    double sum = 0;
+    for (size_t i = 0; i < keys; ++i) {
+        sum += 1.0 / std::pow(double(i + 1), skew);
+        cdf[i] = sum;
+    }
+
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> uniform(0.0, sum);
+    std::vector<TraceOp> trace;
+    trace.reserve(ops);
+    for (size_t i = 0; i < ops; ++i) {
+        size_t rank = std::lower_bound(cdf.begin(), cdf.end(), uniform(rng)) - cdf.begin();
+        trace.push_back(TraceOp{TraceOp::Kind::GET, "k" + std::to_string(rank), ""});
+    }
+    return trace;
+}
+
+// "unix:PATH" or "HOST:PORT"; returns a connected blocking socket or -1
+int dial(const std::string& address) {
+    if (address.compare(0, 5, "unix:") == 0) {
+        int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::strncpy(addr.sun_path, address.c_str() + 5, sizeof(addr.sun_path) - 1);
+        if (connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0) return fd;
+        close(fd);
+        return -1;
+    }
+
+    size_t colon = address.rfind(':');
+    if (colon == std::string::npos) return -1;
+    addrinfo hints{};
+    hints.ai_socktype = SOCK_STREAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(address.substr(0, colon).c_str(), address.substr(colon + 1).c_str(), &hints, &found) != 0) {
+        return -1;
+    }
+    int fd = -1;
+    for (addrinfo* ai = found; ai && fd < 0; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd >= 0 && connect(fd, ai->ai_addr, ai->ai_addrlen) != 0) {
+            close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(found);
+    if (fd >= 0) {
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return fd;
+}
+
+// Blocking request/reply stream over one connection
+class Client {
+public:
+    explicit Client(int fd) : fd_(fd) {}
+    ~Client() { close(fd_); }
+
+    void send(const std::string& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = write(fd_, data.data() + sent, data.size() - sent);
+            if (n <= 0) throw std::runtime_error("write failed");
+            sent += size_t(n);
+        }
+    }
+
+    // Reads one "get" reply; returns whether it carried a value
+    bool readGet() {
+        std::string line = readLine();
+        if (line == "END") return false;
+        size_t space = line.rfind(' ');
+        if (line.compare(0, 6, "VALUE ") != 0 || space == std::string::npos) {
+            throw std::runtime_error("unexpected reply: " + line);
+        }
+        skip(std::stoull(line.substr(space + 1)) + 2);
+        if (readLine() != "END") throw std::runtime_error("expected END");
+        return true;
+    }
+
+    void readStored() {
+        std::string line = readLine();
+        if (line != "STORED") throw std::runtime_error("unexpected reply: " + line);
+    }
+
+    void readDeleted() {
+        std::string line = readLine();
+        if (line != "DELETED" && line != "NOT_FOUND") throw std::runtime_error("unexpected reply: " + line);
+    }
+
+    // Sends "stats" and returns the value of `name`
+    uint64_t stat(const std::string& name) {
+        send("stats\r\n");
+        uint64_t value = 0;
+        for (std::string line = readLine(); line != "END"; line = readLine()) {
+            if (line.compare(0, 6 + name.size(), "STAT " + name + " ") == 0) {
+                value = std::stoull(line.substr(6 + name.size()));
+            }
+        }
+        return value;
+    }
+
+private:
+    int fd_;
+    std::string buffer_;
+    size_t pos_ = 0;
+
+    void fill() {
+        if (pos_ > 0) {
+            buffer_.erase(0, pos_);
+            pos_ = 0;
+        }
+        size_t size = buffer_.size();
+        buffer_.resize(size + 64 * 1024);
+        ssize_t n = read(fd_, &buffer_[size], 64 * 1024);
+        buffer_.resize(size + size_t(std::max<ssize_t>(n, 0)));
+        if (n <= 0) throw std::runtime_error("connection closed");
+    }
+
+    std::string readLine() {
+        size_t eol;
+        while ((eol = buffer_.find("\r\n", pos_)) == std::string::npos) fill();
+        std::string line = buffer_.substr(pos_, eol - pos_);
+        pos_ = eol + 2;
+        return line;
+    }
+
+    void skip(size_t bytes) {
+        while (buffer_.size() - pos_ < bytes) fill();
+        pos_ += bytes;
+    }
+};
+
+std::string setRequest(const TraceOp& op, const std::string& filler) {
+    const std::string& value = op.kind == TraceOp::Kind::PUT && !op.size ? op.value
+                                                                         : filler.substr(0, op.size ? op.size : filler.size());
+    return "set " + op.key + " 0 0 " + std::to_string(value.size()) + "\r\n" + value + "\r\n";
+}
+
+void runConnection(const std::string& address, const std::vector<TraceOp>& trace, size_t offset,
+                   const Options& opt, const std::string& filler, ConnectionResult& out) {
+    int fd = dial(address);
+    if (fd < 0) throw std::runtime_error("cannot connect to " + address);
+    Client client(fd);
+    size_t total = opt.ops ? opt.ops : trace.size();
+    out.latenciesNs.reserve(total + total / 2);
+
+    std::vector<const TraceOp*> batch;
+    std::vector<const TraceOp*> fills;
+    for (size_t n = 0; n < total;) {
+        // One pipelined round: up to `depth` requests, then every reply
+        batch.clear();
+        std::string request;
+        for (; n < total && batch.size() < opt.depth; ++n) {
+            const TraceOp& op = trace[(offset + n) % trace.size()];
+            batch.push_back(&op);
+            request += op.kind == TraceOp::Kind::GET   ? "get " + op.key + "\r\n"
+                       : op.kind == TraceOp::Kind::DEL ? "delete " + op.key + "\r\n"
+                                                       : setRequest(op, filler);
+        }
+        auto start = Clock::now();
+        client.send(request);
+        fills.clear();
+        for (const TraceOp* op : batch) {
+            if (op->kind == TraceOp::Kind::GET) {
+                bool hit = client.readGet();
+                ++(hit ? out.hits : out.misses);
+                if (!hit) fills.push_back(op);
+            } else if (op->kind == TraceOp::Kind::DEL) {
+                client.readDeleted();
+            } else {
+                client.readStored();
+            }
+            out.latenciesNs.push_back(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                Clock::now() - start).count()));
+        }
+        out.requests += batch.size();
+        if (fills.empty()) continue;
+
+        // Demand fills for the misses, pipelined the same way
+        request.clear();
+        for (const TraceOp* op : fills) request += setRequest(*op, filler);
+        start = Clock::now();
+        client.send(request);
+        for (size_t i = 0; i < fills.size(); ++i) {
+            client.readStored();
+            out.latenciesNs.push_back(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                Clock::now() - start).count()));
+        }
+        out.requests += fills.size();
+    }
+}
+
+RunResult runLoad(const std::string& address, const std::vector<TraceOp>& trace, const Options& opt) {
+    std::string filler(opt.valueSize, 'v');
+    for (const auto& op : trace) {
+        if (op.size > filler.size()) filler.assign(op.size, 'v');
+    }
+
+    std::vector<ConnectionResult> results(opt.connections);
+    std::vector<std::string> errors(opt.connections);
+    std::vector<std::thread> threads;
+    auto start = Clock::now();
+    for (size_t c = 0; c < opt.connections; ++c) {
+        threads.emplace_back([&, c]() {
+            try {
+                runConnection(address, trace, trace.size() * c / opt.connections, opt, filler, results[c]);
+            } catch (const std::exception& e) {
+                errors[c] = e.what();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    RunResult run;
+    run.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    for (size_t c = 0; c < opt.connections; ++c) {
+        if (!errors[c].empty()) throw std::runtime_error(errors[c]);
+        run.requests += results[c].requests;
+        run.hits += results[c].hits;
+        run.misses += results[c].misses;
+        run.latenciesNs.insert(run.latenciesNs.end(), results[c].latenciesNs.begin(), results[c].latenciesNs.end());
+    }
+    std::sort(run.latenciesNs.begin(), run.latenciesNs.end());
+
+    int fd = dial(address);
+    if (fd >= 0) {
+        Client client(fd);
+        run.evictions = client.stat("evictions");
+    }
+    return run;
+}
+
+// Starts memcached_server for `policy` on a fresh Unix socket; returns its pid
+pid_t startServer(const Options& opt, const std::string& policy, const std::string& socketPath) {
+    pid_t pid = fork();
+    if (pid == 0) {
+        std::string capacity = std::to_string(opt.capacity);
+        execl(opt.server.c_str(), opt.server.c_str(), "--policy", policy.c_str(), "--capacity", capacity.c_str(),
+              "--unix", socketPath.c_str(), static_cast<char*>(nullptr));
+        std::perror(opt.server.c_str());
+        _exit(127);
+    }
+    // Wait until it accepts connections
+    for (int attempt = 0; attempt < 500; ++attempt) {
+        int fd = dial("unix:" + socketPath);
+        if (fd >= 0) {
+            close(fd);
+            return pid;
+        }
+        if (waitpid(pid, nullptr, WNOHANG) == pid) break;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    kill(pid, SIGTERM);
+    waitpid(pid, nullptr, 0);
+    throw std::runtime_error("memcached_server did not start: " + opt.server);
+}
+
+uint64_t percentile(const std::vector<uint64_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t index = static_cast<size_t>(p * double(sorted.size() - 1));
+    return sorted[index];
+}
+
+void report(const std::string& policy, const RunResult& r) {
+    uint64_t gets = r.hits + r.misses;
+    std::printf("%-10s %12.0f %9llu %9llu %9llu %8.4f %10llu\n",
+        policy.c_str(), double(r.requests) / r.seconds,
+        (unsigned long long)percentile(r.latenciesNs, 0.50),
+        (unsigned long long)percentile(r.latenciesNs, 0.99),
+        (unsigned long long)percentile(r.latenciesNs, 0.999),
+        gets ? double(r.hits) / double(gets) : 0.0, (unsigned long long)r.evictions);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--server" && i + 1 < argc) {
+            opt.server = argv[++i];
+        } else if (arg == "--connect" && i + 1 < argc) {
+            opt.connect = argv[++i];
+        } else if (arg == "--policies" && i + 1 < argc) {
+            opt.policies = splitList(argv[++i]);
+        } else if (arg == "--capacity" && i + 1 < argc) {
+            opt.capacity = std::stoul(argv[++i]);
+        } else if (arg == "--connections" && i + 1 < argc) {
+            opt.connections = std::max<size_t>(1, std::stoul(argv[++i]));
+        } else if (arg == "--depth" && i + 1 < argc) {
+            opt.depth = std::max<size_t>(1, std::stoul(argv[++i]));
+        } else if (arg == "--ops" && i + 1 < argc) {
+            opt.ops = std::stoul(argv[++i]);
+        } else if (arg == "--value-size" && i + 1 < argc) {
+            opt.valueSize = std::stoul(argv[++i]);
+        } else if (!arg.empty() && arg[0] != '-') {
+            opt.tracePath = arg;
+        } else {
+            std::fprintf(stderr, "Unknown argument: %s\n", arg.c_str());
+            return 2;
+        }
+    }
+
+    std::vector<TraceOp> trace;
+    if (opt.tracePath.empty()) {
+        trace = zipfTrace(1000000, 100000, 0.99);
+    } else {
+        std::ifstream in(opt.tracePath);
+        if (!in) {
+            std::fprintf(stderr, "Cannot open %s\n", opt.tracePath.c_str());
+            return 1;
+        }
+        std::stringstream text;
+        text << in.rdbuf();
+        ParseResult parsed = TraceParser::parse(text.str());
+        if (!parsed.success) {
+            for (const auto& error : parsed.errors) std::fprintf(stderr, "%s\n", error.c_str());
+            return 1;
+        }
+        trace = std::move(parsed.operations);
+    }
+    if (trace.empty()) {
+        std::fprintf(stderr, "Trace is empty\n");
+        return 1;
+    }
+
+    std::printf("ops/connection=%zu connections=%zu depth=%zu capacity=%zu\n",
+        opt.ops ? opt.ops : trace.size(), opt.connections, opt.depth, opt.capacity);
+    std::printf("%-10s %12s %9s %9s %9s %8s %10s\n",
+        "policy", "req/s", "p50(ns)", "p99(ns)", "p999(ns)", "hit", "evictions");
+    try {
+        if (!opt.connect.empty()) {
+            report("remote", runLoad(opt.connect, trace, opt));
+            return 0;
+        }
+        for (const auto& policy : opt.policies) {
+            std::string socketPath = "/tmp/memcached_loadgen." + std::to_string(getpid()) + ".sock";
+            pid_t server = startServer(opt, policy, socketPath);
+            RunResult result;
+            try {
+                result = runLoad("unix:" + socketPath, trace, opt);
+            } catch (...) {
+                kill(server, SIGTERM);
+                waitpid(server, nullptr, 0);
+                throw;
+            }
+            kill(server, SIGTERM);
+            waitpid(server, nullptr, 0);
+            report(policy, result);
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
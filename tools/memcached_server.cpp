@@ -0,0 +1,543 @@
+// Memcached text-protocol server backed by a replacement policy.
+//
+// Serves get, set, delete, stats and quit over TCP or a Unix socket
+// from a single epoll loop, so any IPolicy (none is thread-safe) decides
+// what stays resident. The policy only tracks keys; values live in an item
+// store as shared immutable strings, and responses are queued as segments
+// that point at them and written with writev, so a value is never copied
+// on the way out. Every complete command in a read is parsed before the
+// replies are flushed, so pipelined clients get one write per batch.
+// Exptimes are kept on the simulator's TimingWheel in server seconds.
+// Capacity is in entries, like the simulator's. Linux only.
+//
+// Usage: memcached_server [--policy LRU] [--capacity N] [--port 11311 | --unix PATH]
+// SIGINT/SIGTERM stop the server (and remove the Unix socket).
+
+#include "../core/src/policy_factory.hpp"
+#include "../core/src/timing_wheel.hpp"
+
+#ifndef __linux__
+#error "memcached_server needs epoll (Linux)"
+#endif
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using namespace cachesim;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr size_t kReadChunk = 64 * 1024;
+constexpr size_t kMaxLine = 2048;
+constexpr size_t kMaxKeyBytes = 250;
+constexpr uint64_t kMaxValueBytes = 1 << 20;
+constexpr size_t kMaxPendingOut = 8 << 20;  // stop reading a client that does not read its replies
+constexpr int64_t kMaxRelativeExptime = 60 * 60 * 24 * 30; // larger exptimes are Unix times
+constexpr int kMaxEvents = 256;
+
+volatile sig_atomic_t stopping = 0;
+
+struct Options {
+    std::string policy = "LRU";
+    size_t capacity = 10000;
+    int port = 11311;
+    std::string unixPath;
+};
+
+struct Item {
+    uint32_t flags = 0;
+    std::shared_ptr<const std::string> data;
+};
+
+// Queued reply bytes: owned text, or a stored value shared with the item store
+struct Segment {
+    std::string text;
+    std::shared_ptr<const std::string> value;
+    size_t written = 0;
+
+    const char* data() const { return (value ? value->data() : text.data()) + written; }
+    size_t size() const { return (value ? value->size() : text.size()) - written; }
+};
+
+struct Connection {
+    int fd = -1;
+    std::string in;
+    size_t swallow = 0;  // bytes of a rejected value still to discard
+    std::deque<Segment> out;
+    size_t pending = 0;  // unwritten bytes in `out`
+    uint32_t interest = 0;
+    bool closing = false; // "quit": close once the replies are written
+    std::string key;      // scratch, reused across commands
+
+    void appendText(std::string_view text) {
+        if (out.empty() || out.back().value) {
+            out.emplace_back();
+        }
+        out.back().text.append(text);
+        pending += text.size();
+    }
+
+    void appendValue(const std::shared_ptr<const std::string>& value) {
+        Segment segment;
+        segment.value = value;
+        out.push_back(std::move(segment));
+        pending += value->size();
+    }
+};
+
+// The policy plus the values and timers of its resident keys. Invariant:
+// a key is resident in the policy iff it has an item.
+class PolicyStore {
+public:
+    PolicyStore(std::unique_ptr<IPolicy> policy, std::string name, size_t capacity)
+        : policy_(std::move(policy)), name_(std::move(name)), capacity_(capacity), started_(Clock::now()) {}
+
+    const Item* get(const std::string& key) {
+        ++cmd_get_;
+        bool resident = policy_->isCacheHit(key);
+        policy_->get(key, scratch_);
+        if (!resident) {
+            // An ARC ghost hit re-admits the key, but its value is gone
+            if (policy_->isCacheHit(key)) {
+                policy_->erase(key);
+            }
+            ++get_misses_;
+            return nullptr;
+        }
+        ++get_hits_;
+        return &items_.at(key);
+    }
+
+    void set(const std::string& key, Item item, int64_t exptime) {
+        ++cmd_set_;
+        uint64_t expiry = 0;
+        if (exptime != 0) {
+            int64_t relative = exptime > kMaxRelativeExptime ? exptime - int64_t(std::time(nullptr)) : exptime;
+            if (relative <= 0) { // already expired
+                drop(key);
+                return;
+            }
+            expiry = wheel_.now() + uint64_t(relative);
+        }
+
+        auto victim = policy_->putSized(key, std::string(), item.data->size());
+        if (victim) {
+            ++evictions_;
+            drop(*victim, false);
+        }
+        if (!policy_->isCacheHit(key)) { // not admitted (or its own victim)
+            drop(key, false);
+            return;
+        }
+        auto& slot = items_[key];
+        bytes_ += item.data->size() - (slot.data ? slot.data->size() : 0);
+        slot = std::move(item);
+        if (expiry) {
+            wheel_.schedule(key, expiry);
+        } else {
+            wheel_.cancel(key);
+        }
+    }
+
+    bool remove(const std::string& key) {
+        bool found = drop(key);
+        ++(found ? delete_hits_ : delete_misses_);
+        return found;
+    }
+
+    // Expires the items whose exptime has passed
+    void tick() {
+        uint64_t now = uint64_t(std::chrono::duration_cast<std::chrono::seconds>(Clock::now() - started_).count());
+        wheel_.advance(now, [&](const std::string& key) {
+            policy_->erase(key);
+            auto it = items_.find(key);
+            bytes_ -= it->second.data->size();
+            items_.erase(it);
+            ++expirations_;
+        });
+    }
+
+    void appendStats(Connection& conn, size_t connections) const {
+        auto stat = [&](const char* name, unsigned long long value) {
+            char line[96];
+            int n = std::snprintf(line, sizeof(line), "STAT %s %llu\r\n", name, value);
+            conn.appendText(std::string_view(line, size_t(n)));
+        };
+        stat("pid", (unsigned long long)getpid());
+        stat("uptime", (unsigned long long)wheel_.now());
+        stat("time", (unsigned long long)std::time(nullptr));
+        stat("curr_connections", connections);
+        stat("curr_items", items_.size());
+        stat("bytes", bytes_);
+        stat("limit_maxitems", capacity_);
+        stat("cmd_get", cmd_get_);
+        stat("cmd_set", cmd_set_);
+        stat("get_hits", get_hits_);
+        stat("get_misses", get_misses_);
+        stat("delete_hits", delete_hits_);
+        stat("delete_misses", delete_misses_);
+        stat("evictions", evictions_);
+        stat("expirations", expirations_);
+        stat("hit_path_writes", policy_->hitPathWrites());
+        conn.appendText("STAT policy " + name_ + "\r\nEND\r\n");
+    }
+
+private:
+    std::unique_ptr<IPolicy> policy_;
+    std::string name_;
+    size_t capacity_;
+    Clock::time_point started_;
+    std::unordered_map<std::string, Item> items_;
+    TimingWheel wheel_;
+    std::string scratch_;
+    uint64_t bytes_ = 0;
+    uint64_t cmd_get_ = 0, cmd_set_ = 0, get_hits_ = 0, get_misses_ = 0;
+    uint64_t delete_hits_ = 0, delete_misses_ = 0, evictions_ = 0, expirations_ = 0;
+
+    // Forgets `key` everywhere; returns whether it was stored
+    bool drop(const std::string& key, bool fromPolicy = true) {
+        if (fromPolicy) {
+            policy_->erase(key);
+        }
+        wheel_.cancel(key);
+        auto it = items_.find(key);
+        if (it == items_.end()) return false;
+        bytes_ -= it->second.data->size();
+        items_.erase(it);
+        return true;
+    }
+};
+
+// Splits a command line on spaces into at most `max` tokens; returns the count
+size_t tokenize(std::string_view line, std::string_view* tokens, size_t max) {
+    size_t count = 0;
+    size_t i = 0;
+    while (count < max) {
+        while (i < line.size() && line[i] == ' ') ++i;
+        if (i == line.size()) break;
+        size_t start = i;
+        while (i < line.size() && line[i] != ' ') ++i;
+        tokens[count++] = line.substr(start, i - start);
+    }
+    return count;
+}
+
+bool parseNumber(std::string_view text, int64_t& value, bool allowNegative) {
+    bool negative = allowNegative && !text.empty() && text[0] == '-';
+    if (negative) text.remove_prefix(1);
+    if (text.empty() || text.size() > 18) return false;
+    value = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+        value = value * 10 + (c - '0');
+    }
+    if (negative) value = -value;
+    return true;
+}
+
+// Executes every complete command buffered on `conn`, queueing the replies
+void serve(Connection& conn, PolicyStore& store, size_t connections) {
+    size_t pos = std::min(conn.swallow, conn.in.size());
+    conn.swallow -= pos;
+
+    std::string_view tokens[8];
+    while (!conn.closing) {
+        size_t eol = conn.in.find('\n', pos);
+        if (eol == std::string::npos) {
+            if (conn.in.size() - pos > kMaxLine) {
+                conn.appendText("CLIENT_ERROR line too long\r\n");
+                conn.closing = true;
+            }
+            break;
+        }
+        std::string_view line(conn.in.data() + pos, eol - pos);
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        size_t next = eol + 1;
+        size_t count = tokenize(line, tokens, 8);
+        std::string_view command = count ? tokens[0] : std::string_view();
+
+        if (command == "get") {
+            std::string_view rest = line.substr(command.size());
+            std::string_view key;
+            while (tokenize(rest, &key, 1) == 1) {
+                rest = rest.substr(size_t(key.data() + key.size() - rest.data()));
+                conn.key.assign(key);
+                if (const Item* item = store.get(conn.key)) {
+                    char header[32];
+                    int n = std::snprintf(header, sizeof(header), " %u %zu\r\n", item->flags, item->data->size());
+                    conn.appendText("VALUE ");
+                    conn.appendText(key);
+                    conn.appendText(std::string_view(header, size_t(n)));
+                    conn.appendValue(item->data);
+                    conn.appendText("\r\n");
+                }
+            }
+            conn.appendText("END\r\n");
+        } else if (command == "set") {
+            int64_t flags, exptime, bytes;
+            bool noreply = count == 6 && tokens[5] == "noreply";
+            if ((count != 5 && !noreply) || tokens[1].size() > kMaxKeyBytes ||
+                !parseNumber(tokens[2], flags, false) || flags > UINT32_MAX ||
+                !parseNumber(tokens[3], exptime, true) || !parseNumber(tokens[4], bytes, false)) {
+                conn.appendText("CLIENT_ERROR bad command line format\r\n");
+                pos = next;
+                continue;
+            }
+            if (uint64_t(bytes) > kMaxValueBytes) {
+                conn.appendText("SERVER_ERROR object too large for cache\r\n");
+                size_t available = std::min(conn.in.size() - next, size_t(bytes) + 2);
+                conn.swallow = size_t(bytes) + 2 - available;
+                pos = next + available;
+                continue;
+            }
+            size_t end = next + size_t(bytes);
+            if (conn.in.size() < end + 2) {
+                break; // wait for the rest of the value
+            }
+            if (conn.in.compare(end, 2, "\r\n") != 0) {
+                conn.appendText("CLIENT_ERROR bad data chunk\r\n");
+                conn.closing = true;
+                break;
+            }
+            conn.key.assign(tokens[1]);
+            Item item{uint32_t(flags), std::make_shared<const std::string>(conn.in, next, size_t(bytes))};
+            store.set(conn.key, std::move(item), exptime);
+            if (!noreply) conn.appendText("STORED\r\n");
+            next = end + 2;
+        } else if (command == "delete" && (count == 2 || (count == 3 && tokens[2] == "noreply"))) {
+            conn.key.assign(tokens[1]);
+            bool found = store.remove(conn.key);
+            if (count == 2) conn.appendText(found ? "DELETED\r\n" : "NOT_FOUND\r\n");
+        } else if (command == "stats" && count == 1) {
+            store.appendStats(conn, connections);
+        } else if (command == "quit") {
+            conn.closing = true;
+        } else {
+            conn.appendText("ERROR\r\n");
+        }
+        pos = next;
+    }
+    conn.in.erase(0, pos);
+}
+
+// Writes queued replies until done or the socket is full; false on error
+bool flush(Connection& conn) {
+    while (!conn.out.empty()) {
+        iovec iov[IOV_MAX];
+        int n = 0;
+        for (auto it = conn.out.begin(); it != conn.out.end() && n < IOV_MAX; ++it, ++n) {
+            iov[n].iov_base = const_cast<char*>(it->data());
+            iov[n].iov_len = it->size();
+        }
+        ssize_t written = writev(conn.fd, iov, n);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        conn.pending -= size_t(written);
+        size_t left = size_t(written);
+        while (left > 0 && left >= conn.out.front().size()) {
+            left -= conn.out.front().size();
+            conn.out.pop_front();
+        }
+        if (left > 0) conn.out.front().written += left;
+    }
+    return true;
+}
+
+// Reads what the socket has, serves it and flushes; false once the connection should close
+bool onReadable(Connection& conn, PolicyStore& store, size_t connections) {
+    bool open = true;
+    while (conn.pending < kMaxPendingOut && !conn.closing) {
+        size_t size = conn.in.size();
+        conn.in.resize(size + kReadChunk);
+        ssize_t n = read(conn.fd, &conn.in[size], kReadChunk);
+        conn.in.resize(size + size_t(std::max<ssize_t>(n, 0)));
+        if (n > 0) {
+            serve(conn, store, connections);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        open = n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK);
+        break;
+    }
+    return flush(conn) && open;
+}
+
+int listenOn(const Options& opt) {
+    int fd;
+    if (!opt.unixPath.empty()) {
+        fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (opt.unixPath.size() >= sizeof(addr.sun_path)) {
+            std::fprintf(stderr, "Socket path too long: %s\n", opt.unixPath.c_str());
+            return -1;
+        }
+        std::strcpy(addr.sun_path, opt.unixPath.c_str());
+        unlink(opt.unixPath.c_str());
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            std::perror("bind");
+            return -1;
+        }
+    } else {
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        int one = 1;
+        setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(uint16_t(opt.port));
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            std::perror("bind");
+            return -1;
+        }
+    }
+    if (listen(fd, SOMAXCONN) < 0) {
+        std::perror("listen");
+        return -1;
+    }
+    return fd;
+}
+
+void setInterest(int epollFd, Connection& conn) {
+    uint32_t interest = (conn.pending < kMaxPendingOut && !conn.closing ? uint32_t(EPOLLIN) : 0) |
+                        (conn.out.empty() ? 0 : uint32_t(EPOLLOUT));
+    if (interest != conn.interest) {
+        epoll_event event{};
+        event.events = interest;
+        event.data.fd = conn.fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, conn.fd, &event);
+        conn.interest = interest;
+    }
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--policy" && i + 1 < argc) {
+            opt.policy = argv[++i];
+        } else if (arg == "--capacity" && i + 1 < argc) {
+            opt.capacity = std::stoul(argv[++i]);
+        } else if (arg == "--port" && i + 1 < argc) {
+            opt.port = std::stoi(argv[++i]);
+        } else if (arg == "--unix" && i + 1 < argc) {
+            opt.unixPath = argv[++i];
+        } else {
+            std::fprintf(stderr, "Usage: memcached_server [--policy LRU] [--capacity N] "
+                                 "[--port 11311 | --unix PATH]\n");
+            return 2;
+        }
+    }
+
+    std::unique_ptr<IPolicy> policy;
+    try {
+        policy = createPolicy(opt.policy, opt.capacity);
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 2;
+    }
+    PolicyStore store(std::move(policy), opt.policy, opt.capacity);
+
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGINT, [](int) { stopping = 1; });
+    signal(SIGTERM, [](int) { stopping = 1; });
+
+    int listenFd = listenOn(opt);
+    if (listenFd < 0) return 1;
+    int epollFd = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    if (opt.unixPath.empty()) {
+        std::fprintf(stderr, "%s (%zu entries) listening on 127.0.0.1:%d\n", opt.policy.c_str(), opt.capacity, opt.port);
+    } else {
+        std::fprintf(stderr, "%s (%zu entries) listening on %s\n", opt.policy.c_str(), opt.capacity, opt.unixPath.c_str());
+    }
+
+    std::unordered_map<int, std::unique_ptr<Connection>> connections;
+    epoll_event events[kMaxEvents];
+    while (!stopping) {
+        // Wake at least once a second so exptimes pass on an idle server
+        int n = epoll_wait(epollFd, events, kMaxEvents, 1000);
+        if (n < 0 && errno != EINTR) {
+            std::perror("epoll_wait");
+            break;
+        }
+        store.tick();
+        for (int e = 0; e < n; ++e) {
+            int fd = events[e].data.fd;
+            if (fd == listenFd) {
+                int client;
+                while ((client = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                    if (opt.unixPath.empty()) {
+                        int one = 1;
+                        setsockopt(client, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                    }
+                    auto conn = std::make_unique<Connection>();
+                    conn->fd = client;
+                    conn->interest = EPOLLIN;
+                    epoll_event clientEvent{};
+                    clientEvent.events = EPOLLIN;
+                    clientEvent.data.fd = client;
+                    epoll_ctl(epollFd, EPOLL_CTL_ADD, client, &clientEvent);
+                    connections.emplace(client, std::move(conn));
+                }
+                continue;
+            }
+
+            auto it = connections.find(fd);
+            if (it == connections.end()) continue;
+            Connection& conn = *it->second;
+            bool open = true;
+            if (events[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                open = onReadable(conn, store, connections.size());
+            }
+            if (open && (events[e].events & EPOLLOUT)) {
+                open = flush(conn);
+                // Reading may have paused on a full output queue
+                if (open && conn.pending < kMaxPendingOut && !conn.in.empty()) {
+                    serve(conn, store, connections.size());
+                    open = flush(conn);
+                }
+            }
+            if (!open || (conn.closing && conn.out.empty())) {
+                close(fd); // also drops it from the epoll set
+                connections.erase(it);
+                continue;
+            }
+            setInterest(epollFd, conn);
+        }
+    }
+
+    for (auto& entry : connections) close(entry.first);
+    close(listenFd);
+    if (!opt.unixPath.empty()) unlink(opt.unixPath.c_str());
+    return 0;
+}
@@ -0,0 +1,163 @@
+// Benchmark of batched replay with software-prefetched hash probes.
+//
+// Replays a synthetic Zipf workload (demand-fill GETs over 2x capacity
+// keys) through Simulator::applyBatch for each policy and prefetch batch
+// size, and reports throughput and the speedup over unbatched replay. Hit
+// and eviction counts must match across batch sizes; a mismatch is an error.
+// The trace is generated in chunks from a fixed seed, outside the timed
+// region, so memory is bounded by the cache rather than the trace.
+//
+// Usage: prefetch_bench [--capacities 1000000,10000000] [--ops N]
+//                       [--policies LRU,FIFO,ARC] [--batches 0,8,16,32]
+//                       [--skew S]
+// Each run first warms the cache (untimed) with one reference to every key,
+// coldest first, so it starts full, then 2x capacity Zipf ops.
+
+#include "../core/src/policy_factory.hpp"
+#include "../core/src/simulator.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace cachesim;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr size_t kChunkOps = 1 << 16;
+
+struct Options {
+    std::vector<size_t> capacities{1000000, 10000000};
+    size_t ops = 10000000;
+    std::vector<std::string> policies{"LRU", "FIFO", "ARC"};
+    std::vector<size_t> batches{0, 8, 16, 32};
+    double skew = 0.8;
+};
+
+struct RunResult {
+    double seconds = 0;
+    Stats stats;
+};
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+std::vector<size_t> parseList(const std::string& text) {
+    std::vector<size_t> values;
+    for (const auto& item : splitList(text)) values.push_back(std::stoul(item));
+    return values;
+}
+
+// Zipf-like ranks in [0, keys) by inverting the continuous approximation of
+// the CDF, so generation is O(1) per op at any key count
+class ZipfKeys {
+public:
+    ZipfKeys(size_t keys, double skew, uint64_t seed)
+        : keys_(double(keys)), exponent_(1.0 - skew), rng_(seed) {}
+
+    size_t next() {
+        double u = uniform_(rng_);
+        double rank = std::abs(exponent_) < 1e-9
+            ? std::exp(u * std::log(keys_ + 1.0)) - 1.0
+            : std::pow(u * (std::pow(keys_ + 1.0, exponent_) - 1.0) + 1.0, 1.0 / exponent_) - 1.0;
+        return std::min(static_cast<size_t>(rank), static_cast<size_t>(keys_) - 1);
+    }
+
+private:
+    double keys_;
+    double exponent_;
+    std::mt19937_64 rng_;
+    std::uniform_real_distribution<double> uniform_{0.0, 1.0};
+};
+
+// Demand-fill GETs for the next `count` keys from `nextKey`
+template <typename NextKey>
+void fillChunk(std::vector<TraceOp>& chunk, size_t count, NextKey nextKey) {
+    chunk.resize(count);
+    for (auto& op : chunk) {
+        op.kind = TraceOp::Kind::GET;
+        op.fill = true;
+        op.key = "k" + std::to_string(nextKey());
+    }
+}
+
+RunResult replay(const std::string& policyName, size_t capacity, const Options& opt, size_t batch) {
+    auto policy = createPolicy(policyName, capacity);
+    ZipfKeys keys(2 * capacity, opt.skew, 42);
+    std::vector<TraceOp> chunk;
+    RunResult result;
+
+    Stats warmup;
+    size_t coldest = 2 * capacity;
+    for (size_t done = 0; done < 2 * capacity; done += chunk.size()) {
+        fillChunk(chunk, std::min(kChunkOps, 2 * capacity - done), [&]() { return --coldest; });
+        Simulator::applyBatch(chunk.data(), chunk.data() + chunk.size(), *policy, warmup, nullptr, batch);
+    }
+    for (size_t done = 0; done < 2 * capacity; done += chunk.size()) {
+        fillChunk(chunk, std::min(kChunkOps, 2 * capacity - done), [&]() { return keys.next(); });
+        Simulator::applyBatch(chunk.data(), chunk.data() + chunk.size(), *policy, warmup, nullptr, batch);
+    }
+
+    for (size_t done = 0; done < opt.ops; done += chunk.size()) {
+        fillChunk(chunk, std::min(kChunkOps, opt.ops - done), [&]() { return keys.next(); });
+        auto start = Clock::now();
+        Simulator::applyBatch(chunk.data(), chunk.data() + chunk.size(), *policy, result.stats, nullptr, batch);
+        result.seconds += std::chrono::duration<double>(Clock::now() - start).count();
+    }
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--capacities" && i + 1 < argc) {
+            opt.capacities = parseList(argv[++i]);
+        } else if (arg == "--ops" && i + 1 < argc) {
+            opt.ops = std::stoull(argv[++i]);
+        } else if (arg == "--policies" && i + 1 < argc) {
+            opt.policies = splitList(argv[++i]);
+        } else if (arg == "--batches" && i + 1 < argc) {
+            opt.batches = parseList(argv[++i]);
+        } else if (arg == "--skew" && i + 1 < argc) {
+            opt.skew = std::stod(argv[++i]);
+        } else {
+            std::fprintf(stderr, "Usage: prefetch_bench [--capacities N,...] [--ops N] "
+                                 "[--policies LRU,FIFO,ARC] [--batches 0,8,16] [--skew S]\n");
+            return 2;
+        }
+    }
+
+    std::printf("ops=%zu skew=%.2f keys=2x capacity\n", opt.ops, opt.skew);
+    std::printf("%-6s %10s %6s %12s %8s %8s\n", "policy", "capacity", "batch", "ops/s", "speedup", "hit");
+    int status = 0;
+    for (size_t capacity : opt.capacities) {
+        for (const auto& policyName : opt.policies) {
+            RunResult baseline;
+            for (size_t b = 0; b < opt.batches.size(); ++b) {
+                RunResult r = replay(policyName, capacity, opt, opt.batches[b]);
+                if (b == 0) baseline = r;
+                bool same = r.stats.hits == baseline.stats.hits && r.stats.evictions == baseline.stats.evictions;
+                std::printf("%-6s %10zu %6zu %12.0f %7.2fx %8.4f%s\n", policyName.c_str(), capacity,
+                    opt.batches[b], double(opt.ops) / r.seconds, baseline.seconds / r.seconds,
+                    r.stats.hitRatio(), same ? "" : "  MISMATCH");
+                if (!same) status = 1;
+            }
+        }
+    }
+    return status;
+}
@@ -0,0 +1,244 @@
+// Differential check of incremental replay against fresh replay.
+//
+// For each policy and seed, draws a random config (animate or fast mode,
+// step budget, byte budget, time series, checkpoint budget) and a random
+// trace of GETs (with and without demand fill), PUTs and DELs with sizes,
+// timestamps and TTLs. It then edits the trace repeatedly (replace, insert,
+// erase, append, truncate), sometimes changing the step budget as well, and
+// after every edit compares IncrementalSimulator::run with a fresh
+// Simulator::run: stats, every recorded step, the time series and the
+// recording fidelity must be identical. Any difference is reported and makes
+// the exit status 1.
+//
+// Usage: replay_check [--policies LRU,ARC] [--seeds 20] [--edits 12]
+//                     [--ops 3000] [--capacity 10]
+
+#include "../core/src/incremental_simulator.hpp"
+#include "../core/src/policy_factory.hpp"
+#include "../core/src/simulator.hpp"
+
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace cachesim;
+
+namespace {
+
+struct Options {
+    std::vector<std::string> policies{"LRU", "FIFO", "LFU", "ARC", "W-TinyLFU", "S3-FIFO", "SIEVE", "GDSF"};
+    size_t seeds = 20;
+    size_t edits = 12;
+    size_t ops = 3000;
+    size_t capacity = 10;
+};
+
+std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+// Keys over 6x capacity, so hits, misses and evictions all occur
+class TraceGenerator {
+public:
+    TraceGenerator(size_t capacity, uint64_t seed) : keys_(6 * capacity), rng_(seed) {}
+
+    TraceOp next() {
+        TraceOp op{TraceOp::Kind::GET, "k" + std::to_string(rng_() % keys_), ""};
+        uint64_t kind = rng_() % 16;
+        if (kind < 4) {
+            op.kind = TraceOp::Kind::PUT;
+            // Values of very different lengths make step sizes vary, so
+            // thinning depends on which op is last
+            op.value = std::string(1 + rng_() % 200, char('a' + rng_() % 26));
+            if (rng_() % 3 == 0) op.ttl = 1 + rng_() % 40;
+        } else if (kind == 4) {
+            op.kind = TraceOp::Kind::DEL;
+        } else {
+            op.fill = rng_() % 4 != 0;
+            if (op.fill && rng_() % 4 == 0) op.ttl = 1 + rng_() % 40;
+        }
+        if (op.kind != TraceOp::Kind::DEL && rng_() % 2) op.size = 1 + rng_() % 100;
+        time_ += rng_() % 3 == 0;
+        op.timestamp = time_;
+        return op;
+    }
+
+    uint64_t draw(uint64_t bound) { return rng_() % bound; }
+
+    // Timestamps must not go backwards, so edits reuse the neighbour's time
+    void retime(std::vector<TraceOp>& ops, size_t at) {
+        ops[at].timestamp = at > 0 ? ops[at - 1].timestamp : 0;
+    }
+
+private:
+    uint64_t keys_;
+    std::mt19937_64 rng_;
+    uint64_t time_ = 0;
+};
+
+bool sameStats(const Stats& a, const Stats& b) {
+    return a.hits == b.hits && a.misses == b.misses && a.evictions == b.evictions &&
+           a.expirations == b.expirations && a.ghostHits == b.ghostHits && a.hitPathWrites == b.hitPathWrites &&
+           a.bytesHit == b.bytesHit && a.bytesMissed == b.bytesMissed && a.bytesEvicted == b.bytesEvicted;
+}
+
+bool sameStep(const Step& a, const Step& b) {
+    if (a.arc.has_value() != b.arc.has_value()) return false;
+    if (a.arc && (a.arc->T1 != b.arc->T1 || a.arc->T2 != b.arc->T2 || a.arc->B1 != b.arc->B1 ||
+                  a.arc->B2 != b.arc->B2 || a.arc->p != b.arc->p)) {
+        return false;
+    }
+    return a.index == b.index && a.op == b.op && a.key == b.key && a.value == b.value && a.hit == b.hit &&
+           a.evicted == b.evicted && a.cache == b.cache && a.freq == b.freq && sameStats(a.totals, b.totals);
+}
+
+bool sameSteps(const std::vector<Step>& a, const std::vector<Step>& b, std::string& why) {
+    for (size_t i = 0; i < std::min(a.size(), b.size()); ++i) {
+        if (!sameStep(a[i], b[i])) {
+            why = "step " + std::to_string(i) + " (op " + std::to_string(a[i].index) + " vs " +
+                  std::to_string(b[i].index) + ")";
+            return false;
+        }
+    }
+    if (a.size() != b.size()) {
+        why = std::to_string(a.size()) + " steps vs " + std::to_string(b.size());
+        return false;
+    }
+    return true;
+}
+
+// Empty if `incremental` matches `fresh`, else what differs first
+std::string compare(const SimResult& incremental, const SimResult& fresh) {
+    std::string why;
+    if (!sameStats(incremental.stats, fresh.stats)) return "stats";
+    if (!sameSteps(incremental.steps, fresh.steps, why)) return why;
+    if (!sameSteps(incremental.snapshots, fresh.snapshots, why)) return "snapshot " + why;
+    const TimeSeries& a = incremental.series;
+    const TimeSeries& b = fresh.series;
+    if (a.window != b.window || a.hits != b.hits || a.misses != b.misses || a.evictions != b.evictions ||
+        a.arcP != b.arcP || a.lfuMinFrequency != b.lfuMinFrequency || a.smoothedMissRatio != b.smoothedMissRatio) {
+        return "time series";
+    }
+    const RecordingFidelity& x = incremental.fidelity;
+    const RecordingFidelity& y = fresh.fidelity;
+    if (x.stride != y.stride || x.steps != y.steps || x.bytes != y.bytes || x.budget != y.budget) {
+        return "fidelity (stride " + std::to_string(x.stride) + " vs " + std::to_string(y.stride) + ")";
+    }
+    return "";
+}
+
+// Replays one session through `opt.edits` edits; returns the number of mismatches
+size_t check(const std::string& policyName, uint64_t seed, const Options& opt) {
+    // Small budgets keep a handful of steps, so most runs thin
+    static const uint64_t kStepBudgets[] = {0, 1500, 3000, 8000, 20000, 1000000};
+    TraceGenerator gen(opt.capacity, seed);
+
+    SimConfig cfg{opt.capacity, gen.draw(2) == 0, 1 + gen.draw(64)};
+    cfg.byteCapacity = gen.draw(2) ? 0 : 30 * opt.capacity + gen.draw(30 * opt.capacity);
+    cfg.trackBytes = gen.draw(2) == 0;
+    cfg.metricsWindow = gen.draw(2) ? 0 : 1 + gen.draw(64);
+    cfg.metricsAlpha = cfg.metricsWindow && gen.draw(2) ? 0.3 : 0.0;
+    cfg.stepBudget = kStepBudgets[gen.draw(6)];
+    uint64_t checkpointBudget = gen.draw(2) ? 0 : 4096 + gen.draw(64 * 1024);
+    IncrementalSimulator incremental(createPolicy(policyName, opt.capacity), cfg, checkpointBudget);
+
+    std::vector<TraceOp> ops;
+    for (size_t i = 0; i < opt.ops; ++i) ops.push_back(gen.next());
+
+    size_t mismatches = 0;
+    for (size_t edit = 0; edit < opt.edits; ++edit) {
+        size_t at = ops.empty() ? 0 : gen.draw(ops.size());
+        switch (gen.draw(6)) {
+            case 0:
+                if (!ops.empty()) {
+                    ops[at] = gen.next();
+                    gen.retime(ops, at);
+                }
+                break;
+            case 1:
+                ops.insert(ops.begin() + at, gen.next());
+                gen.retime(ops, at);
+                break;
+            case 2:
+                if (!ops.empty()) ops.erase(ops.begin() + at);
+                break;
+            case 3:
+                ops.resize(at);
+                break;
+            default: // appends resume from the checkpoint at the previous trace's end
+                for (size_t i = 1 + gen.draw(gen.draw(2) ? 16 : 300); i > 0; --i) ops.push_back(gen.next());
+                break;
+        }
+        if (gen.draw(4) == 0) {
+            cfg.stepBudget = kStepBudgets[gen.draw(6)];
+            incremental.setStepBudget(cfg.stepBudget);
+        }
+
+        SimResult a = incremental.run(ops);
+        auto policy = createPolicy(policyName, opt.capacity);
+        Simulator simulator;
+        SimResult b = simulator.run(ops, *policy, cfg);
+        std::string why = compare(a, b);
+        if (!why.empty()) {
+            ++mismatches;
+            std::printf("MISMATCH %s seed %llu edit %zu (%zu ops, resumed at %zu, %s, stepBudget %llu): %s\n",
+                policyName.c_str(), (unsigned long long)seed, edit, ops.size(), incremental.resumedFrom(),
+                cfg.animate ? "animate" : "fast", (unsigned long long)cfg.stepBudget, why.c_str());
+        }
+    }
+    return mismatches;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--policies" && i + 1 < argc) {
+            opt.policies = splitList(argv[++i]);
+        } else if (arg == "--seeds" && i + 1 < argc) {
+            opt.seeds = std::stoull(argv[++i]);
+        } else if (arg == "--edits" && i + 1 < argc) {
+            opt.edits = std::stoull(argv[++i]);
+        } else if (arg == "--ops" && i + 1 < argc) {
+            opt.ops = std::stoull(argv[++i]);
+        } else if (arg == "--capacity" && i + 1 < argc) {
+            opt.capacity = std::stoull(argv[++i]);
+        } else {
+            std::fprintf(stderr, "Usage: replay_check [--policies LRU,ARC] [--seeds N] [--edits N] "
+                                 "[--ops N] [--capacity N]\n");
+            return 2;
+        }
+    }
+    if (opt.capacity == 0) {
+        std::fprintf(stderr, "Capacity must be greater than 0\n");
+        return 2;
+    }
+
+    size_t runs = 0, mismatches = 0;
+    try {
+        for (const auto& policyName : opt.policies) {
+            size_t failed = 0;
+            for (uint64_t seed = 1; seed <= opt.seeds; ++seed) {
+                failed += check(policyName, seed, opt);
+                runs += opt.edits;
+            }
+            std::printf("%-10s %zu runs, %zu mismatches\n", policyName.c_str(), opt.seeds * opt.edits, failed);
+            mismatches += failed;
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "Error: %s\n", e.what());
+        return 2;
+    }
+    std::printf("%zu runs, %zu mismatches\n", runs, mismatches);
+    return mismatches ? 1 : 0;
+}
@@ -0,0 +1,91 @@
+// Summarizes a step log written by cachesim_cli --step-log.
+//
+// The file is memory-mapped and decoded block by block, so it works on logs
+// far larger than RAM. Prints the op/block/key counts, the encoded size per
+// op and the hit, ghost-hit and eviction totals recomputed from the columns;
+// --steps FROM:COUNT also prints those records with their key strings.
+//
+// Usage: step_log_inspect <log> [--steps FROM:COUNT]
+
+#include "../core/src/step_log.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+using namespace cachesim;
+
+namespace {
+
+struct Options {
+    std::string path;
+    uint64_t from = 0;
+    uint64_t count = 0;
+};
+
+void printStep(const StepLogReader& log, uint64_t index, const StepRecord& step) {
+    std::string key(log.key(step.key));
+    static const char* const kKinds[] = {"GET", "PUT", "DEL", "?"};
+    std::printf("%10llu %-3s %-8s %-24s", (unsigned long long)index, kKinds[step.kind & 3],
+        step.kind ? "" : step.hit ? "hit" : step.ghostHit ? "ghost" : "miss", key.c_str());
+    if (step.evicted != StepRecord::kNoKey) {
+        std::string victim(log.key(step.evicted));
+        std::printf(" evicted=%s", victim.c_str());
+    }
+    if (step.arcP >= 0) std::printf(" p=%d", step.arcP);
+    if (step.keyFrequency >= 0) std::printf(" freq=%d", step.keyFrequency);
+    std::printf("\n");
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options opt;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--steps" && i + 1 < argc) {
+            std::string range = argv[++i];
+            size_t colon = range.find(':');
+            opt.from = std::stoull(range.substr(0, colon));
+            opt.count = colon == std::string::npos ? 1 : std::stoull(range.substr(colon + 1));
+        } else if (!arg.empty() && arg[0] != '-') {
+            opt.path = arg;
+        } else {
+            std::fprintf(stderr, "Unknown argument: %s\n", arg.c_str());
+            return 2;
+        }
+    }
+    if (opt.path.empty()) {
+        std::fprintf(stderr, "Usage: step_log_inspect <log> [--steps FROM:COUNT]\n");
+        return 2;
+    }
+
+    try {
+        StepLogReader log(opt.path);
+        uint64_t gets = 0, hits = 0, ghostHits = 0, evictions = 0;
+        for (size_t b = 0; b < log.blockCount(); ++b) {
+            const StepColumns& block = log.block(b);
+            for (size_t i = 0; i < block.size(); ++i) {
+                gets += block.kind[i] == 0;
+                hits += block.hit[i];
+                ghostHits += block.ghostHit[i];
+                evictions += block.evicted[i] != StepRecord::kNoKey;
+            }
+        }
+        std::printf("ops=%llu blocks=%zu keys=%zu bytes=%llu (%.2f B/op)\n", (unsigned long long)log.size(),
+            log.blockCount(), log.keyCount(), (unsigned long long)log.fileBytes(),
+            log.size() ? double(log.fileBytes()) / log.size() : 0.0);
+        std::printf("gets=%llu hits=%llu ghostHits=%llu hit=%.4f opsWithEviction=%llu\n",
+            (unsigned long long)gets, (unsigned long long)hits, (unsigned long long)ghostHits,
+            gets ? double(hits) / gets : 0.0, (unsigned long long)evictions);
+
+        uint64_t end = std::min(log.size(), opt.from + opt.count);
+        for (uint64_t index = opt.from; index < end; ++index) {
+            printStep(log, index, log.at(index));
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
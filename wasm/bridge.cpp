@@ -1,15 +1,21 @@
 #include <emscripten/bind.h>
 #include <emscripten/val.h>
 #include <string>
+#include <algorithm>
+#include <list>
+#include <map>
 #include <memory>
 #include <vector>
 
 #include "../core/include/types.hpp"
-#include "../core/src/lru_policy.hpp"
-#include "../core/src/fifo_policy.hpp"
-#include "../core/src/lfu_policy.hpp"
-#include "../core/src/arc_policy.hpp"
+#include "../core/src/hierarchy_simulator.hpp"
+#include "../core/src/incremental_simulator.hpp"
+#include "../core/src/policy_factory.hpp"
+#include "../core/src/profiler.hpp"
+#include "../core/src/result_cache.hpp"
 #include "../core/src/simulator.hpp"
+#include "../core/src/sharded_simulator.hpp"
+#include "../core/src/trace_analyzer.hpp"
 #include "../core/src/trace_parser.hpp"
 #include <emscripten/emscripten.h>
 
@@ -19,6 +25,18 @@ extern "C" {
 
     EMSCRIPTEN_KEEPALIVE
     void free_json(const char* ptr);
+
+    EMSCRIPTEN_KEEPALIVE
+    const char* get_steps_json(int handle, int begin, int end);
+
+    EMSCRIPTEN_KEEPALIVE
+    const char* get_state_json(int handle, int opIndex);
+
+    EMSCRIPTEN_KEEPALIVE
+    const char* get_stats_json(int handle, int opIndex);
+
+    EMSCRIPTEN_KEEPALIVE
+    void close_result(int handle);
 }
 
 
@@ -30,21 +48,12 @@ extern "C" {
 const char* run_simulation_json(const char* requestJson);
 void free_json(const char* ptr);
 
-}
+// Paged access to results kept in wasm (requests with "paged":true)
+const char* get_steps_json(int handle, int begin, int end);
+const char* get_state_json(int handle, int opIndex);
+const char* get_stats_json(int handle, int opIndex);
+void close_result(int handle);
 
-// Helper function to create policy instance
-std::unique_ptr<IPolicy> createPolicy(const std::string& policyName, size_t capacity) {
-    if (policyName == "LRU") {
-        return std::make_unique<LRUPolicy>(capacity);
-    } else if (policyName == "FIFO") {
-        return std::make_unique<FIFOPolicy>(capacity);
-    } else if (policyName == "LFU") {
-        return std::make_unique<LFUPolicy>(capacity);
-    } else if (policyName == "ARC") {
-        return std::make_unique<ARCPolicy>(capacity);
-    } else {
-        throw std::runtime_error("Unknown policy: " + policyName);
-    }
 }
 
 // Simple JSON serialization (for simplicity, using basic string building)
@@ -118,11 +127,122 @@ std::string serializeStats(const Stats& stats) {
     result += "\"hits\":" + std::to_string(stats.hits) + ",";
     result += "\"misses\":" + std::to_string(stats.misses) + ",";
     result += "\"hitRatio\":" + std::to_string(stats.hitRatio()) + ",";
-    result += "\"evictions\":" + std::to_string(stats.evictions);
+    result += "\"evictions\":" + std::to_string(stats.evictions) + ",";
+    result += "\"expirations\":" + std::to_string(stats.expirations) + ",";
+    result += "\"ghostHits\":" + std::to_string(stats.ghostHits) + ",";
+    result += "\"hitPathWrites\":" + std::to_string(stats.hitPathWrites) + ",";
+    result += "\"bytesHit\":" + std::to_string(stats.bytesHit) + ",";
+    result += "\"bytesMissed\":" + std::to_string(stats.bytesMissed) + ",";
+    result += "\"byteHitRatio\":" + std::to_string(stats.byteHitRatio()) + ",";
+    result += "\"bytesEvicted\":" + std::to_string(stats.bytesEvicted);
     result += "}";
     return result;
 }
 
+template <typename T>
+std::string serializeArray(const std::vector<T>& values) {
+    std::string json = "[";
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) json += ",";
+        json += std::to_string(values[i]);
+    }
+    json += "]";
+    return json;
+}
+
+std::string serializeSeries(const TimeSeries& series) {
+    std::string json = "{";
+    json += "\"window\":" + std::to_string(series.window) + ",";
+    json += "\"hits\":" + serializeArray(series.hits) + ",";
+    json += "\"misses\":" + serializeArray(series.misses) + ",";
+    json += "\"evictions\":" + serializeArray(series.evictions) + ",";
+    json += "\"arcP\":" + serializeArray(series.arcP) + ",";
+    json += "\"lfuMinFrequency\":" + serializeArray(series.lfuMinFrequency);
+    if (!series.smoothedMissRatio.empty()) {
+        json += ",\"smoothedMissRatio\":" + serializeArray(series.smoothedMissRatio);
+    }
+    json += "}";
+    return json;
+}
+
+std::string serializeProfile(const TraceProfile& profile) {
+    std::string json = "{";
+    json += "\"ops\":" + std::to_string(profile.ops) + ",";
+    json += "\"samplingRate\":" + std::to_string(profile.samplingRate) + ",";
+    json += "\"uniqueKeys\":" + std::to_string(profile.uniqueKeys) + ",";
+    json += "\"oneHitWonderRatio\":" + std::to_string(profile.oneHitWonderRatio) + ",";
+    json += "\"coldReferences\":" + std::to_string(profile.coldReferences) + ",";
+    json += "\"reuseDistance\":" + serializeArray(profile.reuseDistance) + ",";
+    json += "\"workingSet\":{";
+    json += "\"window\":" + std::to_string(profile.workingSetWindow) + ",";
+    json += "\"stride\":" + std::to_string(profile.workingSetStride) + ",";
+    json += "\"sizes\":" + serializeArray(profile.workingSet);
+    json += "},";
+    json += "\"topKeys\":[";
+    for (size_t i = 0; i < profile.topKeys.size(); ++i) {
+        if (i > 0) json += ",";
+        json += "{\"key\":\"" + profile.topKeys[i].key + "\",";
+        json += "\"count\":" + std::to_string(profile.topKeys[i].count) + ",";
+        json += "\"error\":" + std::to_string(profile.topKeys[i].error) + "}";
+    }
+    json += "]";
+    json += "}";
+    return json;
+}
+
+// Phase timings of one request. With trace events the block is also a valid
+// Chrome trace-event file: save it as JSON and open it in Perfetto or
+// chrome://tracing (spans as "X" events, heap usage as a counter track).
+std::string serializeTiming(const Profiler& profiler, bool traceEvents) {
+    std::string json = "{";
+    json += "\"totalMs\":" + std::to_string(profiler.elapsedUs() / 1000.0) + ",";
+    json += "\"peakHeapBytes\":" + std::to_string(profiler.peakHeapBytes()) + ",";
+    json += "\"phases\":[";
+    std::vector<PhaseTotal> totals = profiler.totals();
+    for (size_t i = 0; i < totals.size(); ++i) {
+        if (i > 0) json += ",";
+        json += "{\"name\":\"" + totals[i].name + "\",";
+        if (!totals[i].detail.empty()) {
+            json += "\"detail\":\"" + totals[i].detail + "\",";
+        }
+        json += "\"ms\":" + std::to_string(totals[i].us / 1000.0) + ",";
+        json += "\"count\":" + std::to_string(totals[i].count) + "}";
+    }
+    json += "]";
+    
+    if (traceEvents) {
+        json += ",\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        const auto& spans = profiler.spans();
+        for (size_t i = 0; i < spans.size(); ++i) {
+            const ProfileSpan& span = spans[i];
+            if (i > 0) json += ",";
+            json += "{\"name\":\"" + span.name + "\",\"cat\":\"cachesim\",\"ph\":\"X\",";
+            json += "\"ts\":" + std::to_string(span.startUs) + ",";
+            json += "\"dur\":" + std::to_string(span.durationUs) + ",\"pid\":1,\"tid\":1";
+            if (!span.detail.empty()) {
+                json += ",\"args\":{\"detail\":\"" + span.detail + "\"}";
+            }
+            json += "},";
+            json += "{\"name\":\"heap\",\"ph\":\"C\",\"ts\":" + std::to_string(span.startUs + span.durationUs);
+            json += ",\"pid\":1,\"args\":{\"bytes\":" + std::to_string(span.heapBytes) + "}}";
+        }
+        json += "]";
+    }
+    json += "}";
+    return json;
+}
+
+std::string serializeFidelity(const RecordingFidelity& fidelity) {
+    std::string json = "{";
+    json += "\"requestedStride\":" + std::to_string(fidelity.requestedStride) + ",";
+    json += "\"stride\":" + std::to_string(fidelity.stride) + ",";
+    json += "\"steps\":" + std::to_string(fidelity.steps) + ",";
+    json += "\"bytes\":" + std::to_string(fidelity.bytes) + ",";
+    json += "\"budget\":" + std::to_string(fidelity.budget);
+    json += "}";
+    return json;
+}
+
 std::string serializeResult(const SimResult& result, const std::string& policyName, size_t capacity) {
     std::string json = "{";
     json += "\"policy\":\"" + policyName + "\",";
@@ -146,21 +266,216 @@ std::string serializeResult(const SimResult& result, const std::string& policyNa
         json += "],";
     }
     
+    if (result.series.window > 0) {
+        json += "\"series\":" + serializeSeries(result.series) + ",";
+    }
+    
+    json += "\"fidelity\":" + serializeFidelity(result.fidelity) + ",";
+    json += "\"stats\":" + serializeStats(result.stats);
+    json += "}";
+    
+    return json;
+}
+
+// Summary of a result kept in wasm: the steps stay behind `handle` and
+// are fetched a window at a time with get_steps_json
+std::string serializePagedResult(const SimResult& result, const std::string& policyName, size_t capacity,
+                                 int handle) {
+    std::string json = "{";
+    json += "\"policy\":\"" + policyName + "\",";
+    json += "\"capacity\":" + std::to_string(capacity) + ",";
+    json += "\"handle\":" + std::to_string(handle) + ",";
+    json += "\"stepCount\":" + std::to_string(result.steps.empty() ? result.snapshots.size() : result.steps.size()) + ",";
+    json += "\"snapshots\":" + std::string(result.steps.empty() ? "true" : "false") + ",";
+    
+    if (result.series.window > 0) {
+        json += "\"series\":" + serializeSeries(result.series) + ",";
+    }
+    
+    json += "\"fidelity\":" + serializeFidelity(result.fidelity) + ",";
+    json += "\"stats\":" + serializeStats(result.stats);
+    json += "}";
+    
+    return json;
+}
+
+std::string serializeShardedResult(const ShardedResult& result, const std::string& policyName, size_t capacity) {
+    std::string json = "{";
+    json += "\"policy\":\"" + policyName + "\",";
+    json += "\"capacity\":" + std::to_string(capacity) + ",";
+    
+    json += "\"shards\":[";
+    for (size_t i = 0; i < result.shards.size(); ++i) {
+        if (i > 0) json += ",";
+        json += "{\"capacity\":" + std::to_string(result.shards[i].capacity) + ",";
+        json += "\"ops\":" + std::to_string(result.shards[i].ops) + ",";
+        json += "\"stats\":" + serializeStats(result.shards[i].stats) + "}";
+    }
+    json += "],";
+    
+    json += "\"imbalance\":{";
+    json += "\"load\":" + std::to_string(result.loadImbalance) + ",";
+    json += "\"minHitRatio\":" + std::to_string(result.minShardHitRatio) + ",";
+    json += "\"maxHitRatio\":" + std::to_string(result.maxShardHitRatio);
+    json += "},";
+    
     json += "\"stats\":" + serializeStats(result.stats);
     json += "}";
     
     return json;
 }
 
+std::string serializeHierarchyResult(const HierarchyResult& result, const std::vector<std::string>& levelPolicies,
+                                     Inclusion inclusion) {
+    std::string json = "{";
+    json += "\"policy\":\"" + levelPolicies[0] + "\",";
+    json += "\"capacity\":" + std::to_string(result.levels[0].capacity) + ",";
+    json += "\"inclusion\":\"" + std::string(inclusion == Inclusion::Inclusive ? "inclusive" :
+                                               inclusion == Inclusion::Exclusive ? "exclusive" : "nine") + "\",";
+    
+    json += "\"levels\":[";
+    for (size_t i = 0; i < result.levels.size(); ++i) {
+        if (i > 0) json += ",";
+        json += "{\"policy\":\"" + levelPolicies[i] + "\",";
+        json += "\"capacity\":" + std::to_string(result.levels[i].capacity) + ",";
+        json += "\"stats\":" + serializeStats(result.levels[i].stats) + "}";
+    }
+    json += "],";
+    
+    json += "\"demotions\":" + std::to_string(result.demotions) + ",";
+    json += "\"invalidations\":" + std::to_string(result.invalidations) + ",";
+    json += "\"stats\":" + serializeStats(result.stats);
+    json += "}";
+    
+    return json;
+}
+
+// Bound on the recorded steps of one request, split evenly across its
+// policies. Results are held twice (the caller's copy and the incremental
+// session's), which leaves the rest of the 32 MB heap for the trace and JSON.
+constexpr uint64_t kDefaultStepBudget = 8 * 1024 * 1024;
+
 // Simple JSON parsing (basic implementation)
 struct JsonRequest {
     size_t capacity;
     std::vector<std::string> policies;
     bool animate;
     size_t snapshotEvery;
+    size_t shards;
+    std::vector<size_t> levels;             // capacities of the levels below L1
+    std::vector<std::string> levelPolicies; // their policies (default: the L1 policy)
+    std::string inclusion;
+    bool demote;
+    uint64_t byteCapacity;
+    size_t metricsWindow;
+    double metricsAlpha;
+    uint64_t stepBudget;
+    bool analyze;
+    bool useCache;
+    bool paged;
+    bool profile;
+    bool profileTrace;
     std::string traceText;
 };
 
+// Reads an unsigned integer field such as "capacity":3; returns fallback if absent
+uint64_t parseUnsignedField(const std::string& jsonStr, const std::string& name, uint64_t fallback) {
+    std::string pattern = "\"" + name + "\":";
+    size_t pos = jsonStr.find(pattern);
+    if (pos == std::string::npos) {
+        return fallback;
+    }
+    size_t start = pos + pattern.length();
+    size_t end = jsonStr.find_first_not_of("0123456789", start);
+    if (end == std::string::npos || end == start) {
+        return fallback;
+    }
+    return std::stoull(jsonStr.substr(start, end - start));
+}
+
+// Reads a non-negative decimal field such as "metricsAlpha":0.1
+double parseDoubleField(const std::string& jsonStr, const std::string& name, double fallback) {
+    std::string pattern = "\"" + name + "\":";
+    size_t pos = jsonStr.find(pattern);
+    if (pos == std::string::npos) {
+        return fallback;
+    }
+    size_t start = pos + pattern.length();
+    size_t end = jsonStr.find_first_not_of("0123456789.eE+-", start);
+    if (end == start) {
+        return fallback;
+    }
+    return std::stod(jsonStr.substr(start, end == std::string::npos ? std::string::npos : end - start));
+}
+
+// Reads a boolean field such as "analyze":true; returns fallback if absent
+bool parseBoolField(const std::string& jsonStr, const std::string& name, bool fallback) {
+    std::string pattern = "\"" + name + "\":";
+    size_t pos = jsonStr.find(pattern);
+    if (pos == std::string::npos) {
+        return fallback;
+    }
+    return jsonStr.compare(pos + pattern.length(), 4, "true") == 0;
+}
+
+// Reads the quoted string field such as "inclusion":"nine"; returns fallback if absent
+std::string parseStringField(const std::string& jsonStr, const std::string& name, const std::string& fallback) {
+    std::string pattern = "\"" + name + "\":\"";
+    size_t pos = jsonStr.find(pattern);
+    if (pos == std::string::npos) {
+        return fallback;
+    }
+    size_t start = pos + pattern.length();
+    size_t end = jsonStr.find("\"", start);
+    return end == std::string::npos ? fallback : jsonStr.substr(start, end - start);
+}
+
+// Reads the quoted strings of an array field such as "policies":["LRU","ARC"]
+std::vector<std::string> parseStringArray(const std::string& jsonStr, const std::string& name) {
+    std::vector<std::string> values;
+    size_t fieldPos = jsonStr.find("\"" + name + "\":");
+    if (fieldPos == std::string::npos) {
+        return values;
+    }
+    size_t start = jsonStr.find("[", fieldPos);
+    size_t end = jsonStr.find("]", start);
+    if (start == std::string::npos || end == std::string::npos) {
+        return values;
+    }
+    std::string arrayStr = jsonStr.substr(start + 1, end - start - 1);
+    size_t pos = 0;
+    while ((pos = arrayStr.find("\"", pos)) != std::string::npos) {
+        size_t endQuote = arrayStr.find("\"", pos + 1);
+        if (endQuote == std::string::npos) {
+            break;
+        }
+        values.push_back(arrayStr.substr(pos + 1, endQuote - pos - 1));
+        pos = endQuote + 1;
+    }
+    return values;
+}
+
+// Reads an array of unsigned integers such as "levels":[64,1024]
+std::vector<size_t> parseUnsignedArray(const std::string& jsonStr, const std::string& name) {
+    std::vector<size_t> values;
+    std::string pattern = "\"" + name + "\":[";
+    size_t pos = jsonStr.find(pattern);
+    if (pos == std::string::npos) {
+        return values;
+    }
+    size_t end = jsonStr.find("]", pos);
+    pos += pattern.length();
+    while (pos < end) {
+        size_t next = jsonStr.find_first_not_of("0123456789", pos);
+        if (next == pos) {
+            break;
+        }
+        values.push_back(std::stoull(jsonStr.substr(pos, next - pos)));
+        pos = next + 1; // skip the comma
+    }
+    return values;
+}
+
 JsonRequest parseJsonRequest(const std::string& jsonStr) {
     JsonRequest req;
     req.capacity = 3;
@@ -168,50 +483,48 @@ JsonRequest parseJsonRequest(const std::string& jsonStr) {
     req.snapshotEvery = 1000;
     
     // Extract capacity
-    size_t capPos = jsonStr.find("\"capacity\":");
-    if (capPos != std::string::npos) {
-        size_t start = capPos + 11;
-        size_t end = jsonStr.find_first_not_of("0123456789", start);
-        if (end != std::string::npos) {
-            req.capacity = std::stoul(jsonStr.substr(start, end - start));
-        }
-    }
+    req.capacity = parseUnsignedField(jsonStr, "capacity", req.capacity);
     
     // Extract animate
-    size_t animPos = jsonStr.find("\"animate\":");
-    if (animPos != std::string::npos) {
-        req.animate = jsonStr.find("true", animPos) != std::string::npos;
-    }
+    req.animate = parseBoolField(jsonStr, "animate", req.animate);
     
     // Extract snapshotEvery
-    size_t snapPos = jsonStr.find("\"snapshotEvery\":");
-    if (snapPos != std::string::npos) {
-        size_t start = snapPos + 16;
-        size_t end = jsonStr.find_first_not_of("0123456789", start);
-        if (end != std::string::npos) {
-            req.snapshotEvery = std::stoul(jsonStr.substr(start, end - start));
-        }
-    }
+    req.snapshotEvery = parseUnsignedField(jsonStr, "snapshotEvery", req.snapshotEvery);
+    
+    // Extract shards (1 = single global cache)
+    req.shards = parseUnsignedField(jsonStr, "shards", 1);
+    
+    // Extract hierarchy levels below L1 (none = single-level cache)
+    req.levels = parseUnsignedArray(jsonStr, "levels");
+    req.levelPolicies = parseStringArray(jsonStr, "levelPolicies");
+    req.inclusion = parseStringField(jsonStr, "inclusion", "nine");
+    req.demote = parseBoolField(jsonStr, "demote", false);
+    
+    // Extract byteCapacity (0 = entry capacity only)
+    req.byteCapacity = parseUnsignedField(jsonStr, "byteCapacity", 0);
+    
+    // Extract time-series options (0 = no series)
+    req.metricsWindow = parseUnsignedField(jsonStr, "metricsWindow", 0);
+    req.metricsAlpha = parseDoubleField(jsonStr, "metricsAlpha", 0.0);
+    
+    // Extract stepBudget (estimated bytes of recorded steps for all policies)
+    req.stepBudget = parseUnsignedField(jsonStr, "stepBudget", kDefaultStepBudget);
+    
+    // Extract analyze (trace characterization computed during parsing)
+    req.analyze = parseBoolField(jsonStr, "analyze", false);
+    
+    // Extract cache (false = always re-simulate)
+    req.useCache = parseBoolField(jsonStr, "cache", true);
+    
+    // Extract paged (keep steps in wasm behind a handle)
+    req.paged = parseBoolField(jsonStr, "paged", false);
+    
+    // Extract profile (phase timings; profileTrace adds Chrome trace events)
+    req.profileTrace = parseBoolField(jsonStr, "profileTrace", false);
+    req.profile = req.profileTrace || parseBoolField(jsonStr, "profile", false);
     
     // Extract policies
-    size_t policiesPos = jsonStr.find("\"policies\":");
-    if (policiesPos != std::string::npos) {
-        size_t start = jsonStr.find("[", policiesPos);
-        size_t end = jsonStr.find("]", start);
-        if (start != std::string::npos && end != std::string::npos) {
-            std::string policiesStr = jsonStr.substr(start + 1, end - start - 1);
-            size_t pos = 0;
-            while ((pos = policiesStr.find("\"", pos)) != std::string::npos) {
-                size_t endQuote = policiesStr.find("\"", pos + 1);
-                if (endQuote != std::string::npos) {
-                    req.policies.push_back(policiesStr.substr(pos + 1, endQuote - pos - 1));
-                    pos = endQuote + 1;
-                } else {
-                    break;
-                }
-            }
-        }
-    }
+    req.policies = parseStringArray(jsonStr, "policies");
     
     // Extract traceText - completely rewritten approach
     size_t tracePos = jsonStr.find("\"traceText\":");
@@ -249,85 +562,403 @@ JsonRequest parseJsonRequest(const std::string& jsonStr) {
     return req;
 }
 
+// Results from earlier requests in this session, keyed by trace content +
+// policy + capacity + mode, so re-runs only simulate what changed
+constexpr size_t kResultCacheBytes = 8 * 1024 * 1024;
+
+ResultCache& resultCache() {
+    static ResultCache cache(kResultCacheBytes);
+    return cache;
+}
+
+// The step budget is only part of a result's key when it thinned the
+// recording: an unthinned result is the same under any budget its steps
+// fit, so adding a policy to a comparison (a smaller share each) re-uses it
+std::string thinnedKey(const std::string& key, uint64_t stepBudget) {
+    return key + "|s" + std::to_string(stepBudget);
+}
+
+std::string resultKey(const std::string& key, const RecordingFidelity& fidelity) {
+    return fidelity.stride != fidelity.requestedStride ? thinnedKey(key, fidelity.budget) : key;
+}
+
+bool fitsBudget(uint64_t stepBytes, uint64_t stepBudget) {
+    return stepBudget == 0 || stepBytes <= stepBudget;
+}
+
+bool lookupResult(const std::string& key, uint64_t stepBudget, std::string& out) {
+    if (resultCache().lookup(thinnedKey(key, stepBudget), out)) {
+        return true;
+    }
+    if (!resultCache().lookup(key, out)) {
+        return false;
+    }
+    size_t fidelity = out.rfind("\"fidelity\":");
+    return fidelity == std::string::npos ||
+           fitsBudget(parseUnsignedField(out.substr(fidelity), "bytes", 0), stepBudget);
+}
+
+// Per policy + mode simulators that keep checkpoints of the last trace, so
+// an edited trace only replays from the first changed op. What they keep
+// (checkpoints and last results) shares one heap budget: a request's
+// sessions split it for their checkpoints, and older sessions are dropped
+// once the total is over it.
+constexpr size_t kMaxSessions = 8;
+constexpr uint64_t kSessionBytes = 8 * 1024 * 1024;
+
+struct SimSession {
+    std::string key;
+    std::shared_ptr<IncrementalSimulator> simulator; // shared: a run may outlive its slot
+};
+
+std::list<SimSession>& simSessions() {
+    static std::list<SimSession> sessions; // most recently used first
+    return sessions;
+}
+
+std::shared_ptr<IncrementalSimulator> simSession(const std::string& key, const std::string& policyName,
+                                                 const SimConfig& config, uint64_t checkpointBudget) {
+    auto& sessions = simSessions();
+    for (auto it = sessions.begin(); it != sessions.end(); ++it) {
+        if (it->key == key) {
+            sessions.splice(sessions.begin(), sessions, it);
+            sessions.front().simulator->setStepBudget(config.stepBudget);
+            sessions.front().simulator->setCheckpointBudget(checkpointBudget);
+            return sessions.front().simulator;
+        }
+    }
+    if (sessions.size() == kMaxSessions) {
+        sessions.pop_back();
+    }
+    sessions.push_front(SimSession{key, std::make_shared<IncrementalSimulator>(
+        createPolicy(policyName, config.capacity), config, checkpointBudget)});
+    return sessions.front().simulator;
+}
+
+// Drops the least recently used sessions, past the `keep` newest, while
+// what they retain is over the budget
+void trimSessions(size_t keep) {
+    auto& sessions = simSessions();
+    uint64_t bytes = 0;
+    size_t count = 0;
+    for (auto it = sessions.begin(); it != sessions.end(); ++it, ++count) {
+        bytes += it->simulator->retainedBytes();
+        if (count >= keep && bytes > kSessionBytes) {
+            sessions.erase(it, sessions.end());
+            break;
+        }
+    }
+}
+
+// Results of paged requests, by handle. The UI closes the handles of a run
+// when it starts the next one; the oldest are dropped if it does not.
+constexpr size_t kMaxPagedResults = 32;
+
+struct PagedResult {
+    std::shared_ptr<const SimResult> result; // shared with pagedCache() and other handles
+    
+    // Recorded steps in animate mode, snapshots in fast mode
+    const std::vector<Step>& frames() const {
+        return result->steps.empty() ? result->snapshots : result->steps;
+    }
+};
+
+std::map<int, PagedResult>& pagedResults() {
+    static std::map<int, PagedResult> results;
+    return results;
+}
+
+int storePagedResult(std::shared_ptr<const SimResult> result) {
+    static int nextHandle = 1;
+    auto& results = pagedResults();
+    if (results.size() == kMaxPagedResults) {
+        results.erase(results.begin());
+    }
+    int handle = nextHandle++;
+    results.emplace(handle, PagedResult{std::move(result)});
+    return handle;
+}
+
+// Recent paged results by result key (as in the result cache), so a re-run
+// gets a new handle to the same result instead of simulating again. Bounded
+// by the results' estimated step bytes; the newest is always kept.
+constexpr uint64_t kPagedCacheBytes = 8 * 1024 * 1024;
+
+struct CachedPagedResult {
+    std::string key;
+    std::shared_ptr<const SimResult> result;
+};
+
+std::list<CachedPagedResult>& pagedCache() {
+    static std::list<CachedPagedResult> cache; // most recently used first
+    return cache;
+}
+
+std::shared_ptr<const SimResult> lookupPagedResult(const std::string& key, uint64_t stepBudget) {
+    auto& cache = pagedCache();
+    std::string thinned = thinnedKey(key, stepBudget);
+    for (auto it = cache.begin(); it != cache.end(); ++it) {
+        if (it->key == thinned || (it->key == key && fitsBudget(it->result->fidelity.bytes, stepBudget))) {
+            cache.splice(cache.begin(), cache, it);
+            return cache.front().result;
+        }
+    }
+    return nullptr;
+}
+
+void storePagedCached(const std::string& key, std::shared_ptr<const SimResult> result) {
+    auto& cache = pagedCache();
+    cache.push_front(CachedPagedResult{resultKey(key, result->fidelity), std::move(result)});
+    uint64_t bytes = 0;
+    for (auto it = cache.begin(); it != cache.end(); ++it) {
+        bytes += it->result->fidelity.bytes;
+        if (it != cache.begin() && bytes > kPagedCacheBytes) {
+            cache.erase(it, cache.end());
+            break;
+        }
+    }
+}
+
+// Last recorded frame at or before trace op `opIndex`, or null if none
+const Step* frameAt(const PagedResult& paged, int opIndex) {
+    const auto& frames = paged.frames();
+    auto it = std::upper_bound(frames.begin(), frames.end(), opIndex,
+                               [](int index, const Step& step) { return index < step.index; });
+    return it == frames.begin() ? nullptr : &*std::prev(it);
+}
+
+// Inserts `fields` ("name":value, pairs) at the start of a JSON object
+std::string withFields(const std::string& objectJson, const std::string& fields) {
+    return fields.empty() ? objectJson : "{" + fields + objectJson.substr(1);
+}
+
+char* toCString(const std::string& json) {
+    char* result = static_cast<char*>(malloc(json.length() + 1));
+    strcpy(result, json.c_str());
+    return result;
+}
+
 const char* run_simulation_json(const char* requestJson) {
     try {
+        Profiler profiler;
         std::string jsonStr(requestJson);
+        size_t span = profiler.begin("request");
         JsonRequest req = parseJsonRequest(jsonStr);
+        profiler.end(span);
         
-        // Parse trace
-        ParseResult parseResult = TraceParser::parse(req.traceText);
-        
-        if (!parseResult.success) {
-            std::string errorJson = "{\"error\":\"Parse failed\",\"details\":[";
-            for (size_t i = 0; i < parseResult.errors.size(); ++i) {
-                if (i > 0) errorJson += ",";
-                errorJson += "\"" + parseResult.errors[i] + "\"";
-            }
-            errorJson += "],\"debug\":\"\",\"parseDebug\":\"\"}";
-            
-            char* result = static_cast<char*>(malloc(errorJson.length() + 1));
-            strcpy(result, errorJson.c_str());
-            return result;
-        }
-        
-        // Debug: check if operations were parsed
-        if (parseResult.operations.empty()) {
-            std::string errorJson = "{\"error\":\"No operations parsed from trace\",\"traceText\":\"" + req.traceText + "\",\"debug\":\"\",\"parseDebug\":\"\"}";
-            char* result = static_cast<char*>(malloc(errorJson.length() + 1));
-            strcpy(result, errorJson.c_str());
-            return result;
+        // If no policies specified, default to LRU
+        if (req.policies.empty()) {
+            req.policies.push_back("LRU");
         }
         
-        // Validate capacity
-        if (req.capacity == 0) {
-            std::string errorJson = "{\"error\":\"Capacity must be greater than 0\"}";
-            char* result = static_cast<char*>(malloc(errorJson.length() + 1));
-            strcpy(result, errorJson.c_str());
-            return result;
+        // Everything except the policy name and step budget that shapes a result
+        span = profiler.begin("cache");
+        uint64_t stepBudget = req.stepBudget / req.policies.size();
+        std::string traceId = std::to_string(ResultCache::hashText(req.traceText)) + ":" +
+                              std::to_string(req.traceText.size());
+        std::string modeId = std::to_string(req.capacity) + "|" + (req.animate ? "a" : "f") + "|" +
+                             std::to_string(req.snapshotEvery) + "|" + std::to_string(req.shards) + "|" +
+                             std::to_string(req.byteCapacity) + "|" + std::to_string(req.metricsWindow) + "|" +
+                             std::to_string(req.metricsAlpha);
+        for (size_t j = 0; j < req.levels.size(); ++j) {
+            modeId += "|L" + std::to_string(req.levels[j]) + ":" +
+                      (j < req.levelPolicies.size() ? req.levelPolicies[j] : "") + ":" + req.inclusion +
+                      (req.demote ? ":d" : "");
         }
+        bool stepless = req.shards > 1 || !req.levels.empty(); // stats-only modes
         
-        // If no policies specified, default to LRU
-        if (req.policies.empty()) {
-            req.policies.push_back("LRU");
+        std::vector<std::string> results(req.policies.size());
+        std::vector<size_t> missing;
+        for (size_t i = 0; i < req.policies.size(); ++i) {
+            std::string key = traceId + "|" + req.policies[i] + "|" + modeId;
+            if (req.paged && !stepless) {
+                // A cached result gets a fresh handle; handles are per call
+                auto cached = req.useCache ? lookupPagedResult(key, stepBudget) : nullptr;
+                if (!cached) {
+                    missing.push_back(i);
+                    continue;
+                }
+                results[i] = serializePagedResult(*cached, req.policies[i], req.capacity, storePagedResult(cached));
+            } else if (!req.useCache || !lookupResult(key, stepBudget, results[i])) {
+                missing.push_back(i);
+            }
         }
+        std::string analysisJson;
+        std::string analysisKey = traceId + "|analysis";
+        bool needAnalysis = req.analyze && (!req.useCache || !resultCache().lookup(analysisKey, analysisJson));
+        profiler.end(span);
         
-        // Run simulation for each policy
-        if (req.policies.size() == 1) {
-            // Single policy
-            auto policy = createPolicy(req.policies[0], req.capacity);
-            Simulator simulator;
-            SimConfig config{req.capacity, req.animate, req.snapshotEvery};
-            SimResult result = simulator.run(parseResult.operations, *policy, config);
+        if (!missing.empty() || needAnalysis) {
+            // Parse trace, feeding the analyzer in the same pass if requested
+            std::unique_ptr<TraceAnalyzer> analyzer;
+            std::function<void(const TraceOp&)> onOp;
+            if (needAnalysis) {
+                analyzer = std::make_unique<TraceAnalyzer>();
+                onOp = [&](const TraceOp& op) { analyzer->observe(op); };
+            }
+            span = profiler.begin("parse");
+            ParseResult parseResult = TraceParser::parse(req.traceText, onOp);
+            profiler.end(span);
             
-            std::string json = serializeResult(result, req.policies[0], req.capacity);
-            char* jsonResult = static_cast<char*>(malloc(json.length() + 1));
-            strcpy(jsonResult, json.c_str());
-            return jsonResult;
-        } else {
-            // Multiple policies - comparison mode
-            std::string json = "[";
-            for (size_t i = 0; i < req.policies.size(); ++i) {
-                if (i > 0) json += ",";
+            if (!parseResult.success) {
+                std::string errorJson = "{\"error\":\"Parse failed\",\"details\":[";
+                for (size_t i = 0; i < parseResult.errors.size(); ++i) {
+                    if (i > 0) errorJson += ",";
+                    errorJson += "\"" + parseResult.errors[i] + "\"";
+                }
+                errorJson += "],\"debug\":\"\",\"parseDebug\":\"\"}";
+                return toCString(errorJson);
+            }
+            
+            // Debug: check if operations were parsed
+            if (parseResult.operations.empty()) {
+                return toCString("{\"error\":\"No operations parsed from trace\",\"traceText\":\"" + req.traceText + "\",\"debug\":\"\",\"parseDebug\":\"\"}");
+            }
+            
+            // Validate capacity
+            if (req.capacity == 0) {
+                return toCString("{\"error\":\"Capacity must be greater than 0\"}");
+            }
+            
+            if (!req.levels.empty() && (req.shards > 1 || req.byteCapacity > 0)) {
+                return toCString("{\"error\":\"Hierarchy levels cannot be combined with shards or byteCapacity\"}");
+            }
+            
+            if (analyzer) {
+                analysisJson = serializeProfile(analyzer->profile());
+                resultCache().store(analysisKey, analysisJson);
+            }
+            
+            // Byte stats are reported when there is a byte budget or the trace carries sizes
+            bool trackBytes = req.byteCapacity > 0;
+            for (const auto& op : parseResult.operations) {
+                if (op.size) {
+                    trackBytes = true;
+                    break;
+                }
+            }
+            
+            // Simulate only the policies not already cached
+            if (stepless) {
+                for (size_t i : missing) {
+                    const std::string& policyName = req.policies[i];
+                    if (!req.levels.empty()) {
+                        // Hierarchy mode: stats only, this policy is L1 in front of the requested levels
+                        std::vector<std::string> levelPolicies{policyName};
+                        std::vector<size_t> capacities{req.capacity};
+                        for (size_t j = 0; j < req.levels.size(); ++j) {
+                            if (req.levels[j] == 0) {
+                                return toCString("{\"error\":\"Capacity must be greater than 0\"}");
+                            }
+                            levelPolicies.push_back(j < req.levelPolicies.size() ? req.levelPolicies[j] : policyName);
+                            capacities.push_back(req.levels[j]);
+                        }
+                        span = profiler.begin("simulate", policyName);
+                        std::vector<std::unique_ptr<IPolicy>> owned;
+                        std::vector<IPolicy*> levels;
+                        for (size_t j = 0; j < capacities.size(); ++j) {
+                            owned.push_back(createPolicy(levelPolicies[j], capacities[j]));
+                            levels.push_back(owned.back().get());
+                        }
+                        HierarchyConfig hierarchy{HierarchySimulator::parseInclusion(req.inclusion), req.demote};
+                        HierarchySimulator simulator;
+                        HierarchyResult result = simulator.run(parseResult.operations, levels, capacities, hierarchy);
+                        profiler.end(span);
+                        Profiler::Scope serializing(profiler, "serialize", policyName);
+                        results[i] = serializeHierarchyResult(result, levelPolicies, hierarchy.inclusion);
+                    } else if (req.shards > 1) {
+                        // Sharded mode: stats only, one independent policy instance per shard
+                        span = profiler.begin("simulate", policyName);
+                        ShardedSimulator simulator;
+                        ShardedResult result = simulator.run(parseResult.operations,
+                            [&](size_t shardCapacity) { return createPolicy(policyName, shardCapacity); },
+                            req.capacity, req.shards, req.byteCapacity, trackBytes);
+                        profiler.end(span);
+                        Profiler::Scope serializing(profiler, "serialize", policyName);
+                        results[i] = serializeShardedResult(result, policyName, req.capacity);
+                    }
+                    if (req.useCache) {
+                        resultCache().store(traceId + "|" + policyName + "|" + modeId, results[i]);
+                    }
+                }
+            } else if (!missing.empty()) {
+                SimConfig config{req.capacity, req.animate, req.snapshotEvery, req.byteCapacity, trackBytes,
+                                 req.metricsWindow, req.metricsAlpha, stepBudget};
+                std::vector<std::string> names; // distinct, in request order
+                for (size_t i : missing) {
+                    if (std::find(names.begin(), names.end(), req.policies[i]) == names.end()) {
+                        names.push_back(req.policies[i]);
+                    }
+                }
                 
-                auto policy = createPolicy(req.policies[i], req.capacity);
-                Simulator simulator;
-                SimConfig config{req.capacity, req.animate, req.snapshotEvery};
-                SimResult result = simulator.run(parseResult.operations, *policy, config);
+                // Every session finds its resume point from the same prefix hashes
+                std::shared_ptr<const std::vector<uint64_t>> hashes;
+                if (req.useCache) {
+                    hashes = std::make_shared<const std::vector<uint64_t>>(
+                        IncrementalSimulator::prefixHashes(parseResult.operations));
+                }
+                std::vector<SimResult> simResults;
+                for (const auto& policyName : names) {
+                    span = profiler.begin("simulate", policyName);
+                    if (req.useCache) {
+                        std::string sessionKey = policyName + "|" + modeId + (trackBytes ? "|b" : "");
+                        simResults.push_back(simSession(sessionKey, policyName, config, kSessionBytes / names.size())
+                                                 ->run(parseResult.operations, hashes));
+                    } else {
+                        auto policy = createPolicy(policyName, req.capacity);
+                        Simulator simulator;
+                        simResults.push_back(simulator.run(parseResult.operations, *policy, config));
+                    }
+                    profiler.end(span);
+                }
+                if (req.useCache) {
+                    trimSessions(names.size());
+                }
                 
-                json += serializeResult(result, req.policies[i], req.capacity);
+                std::vector<std::shared_ptr<const SimResult>> pagedShared(names.size());
+                for (size_t i : missing) {
+                    const std::string& policyName = req.policies[i];
+                    size_t j = std::find(names.begin(), names.end(), policyName) - names.begin();
+                    std::string key = traceId + "|" + policyName + "|" + modeId;
+                    Profiler::Scope serializing(profiler, "serialize", policyName);
+                    if (req.paged) {
+                        if (!pagedShared[j]) {
+                            pagedShared[j] = std::make_shared<const SimResult>(std::move(simResults[j]));
+                            if (req.useCache) storePagedCached(key, pagedShared[j]);
+                        }
+                        results[i] = serializePagedResult(*pagedShared[j], policyName, req.capacity,
+                                                          storePagedResult(pagedShared[j]));
+                        continue;
+                    }
+                    const SimResult& result = simResults[j];
+                    results[i] = serializeResult(result, policyName, req.capacity);
+                    if (req.useCache) {
+                        resultCache().store(resultKey(key, result.fidelity), results[i]);
+                    }
+                }
             }
-            json += "]";
-            
-            char* jsonResult = static_cast<char*>(malloc(json.length() + 1));
-            strcpy(jsonResult, json.c_str());
-            return jsonResult;
         }
         
+        // One policy returns an object, several an array (comparison mode);
+        // the analysis and profile are attached to the first result
+        std::string requestFields = req.analyze ? "\"analysis\":" + analysisJson + "," : "";
+        if (req.profile) {
+            requestFields += "\"profile\":" + serializeTiming(profiler, req.profileTrace) + ",";
+        }
+        if (results.size() == 1) {
+            return toCString(withFields(results[0], requestFields));
+        }
+        std::string json = "[";
+        for (size_t i = 0; i < results.size(); ++i) {
+            if (i > 0) json += ",";
+            json += i == 0 ? withFields(results[i], requestFields) : results[i];
+        }
+        json += "]";
+        return toCString(json);
+        
     } catch (const std::exception& e) {
         std::string errorJson = "{\"error\":\"Simulation failed: " + std::string(e.what()) + "\"}";
-        char* result = static_cast<char*>(malloc(errorJson.length() + 1));
-        strcpy(result, errorJson.c_str());
-        return result;
+        return toCString(errorJson);
     }
 }
 
@@ -337,6 +968,49 @@ void free_json(const char* ptr) {
     }
 }
 
+// Frames [begin, end) of a paged result, clamped to the recorded range
+const char* get_steps_json(int handle, int begin, int end) {
+    auto it = pagedResults().find(handle);
+    if (it == pagedResults().end()) {
+        return toCString("{\"error\":\"Unknown result handle\"}");
+    }
+    const auto& frames = it->second.frames();
+    size_t from = static_cast<size_t>(std::max(begin, 0));
+    size_t to = std::min(static_cast<size_t>(std::max(end, 0)), frames.size());
+    std::string json = "[";
+    for (size_t i = from; i < to; ++i) {
+        if (i > from) json += ",";
+        json += serializeStep(frames[i]);
+    }
+    json += "]";
+    return toCString(json);
+}
+
+// Cache state after trace op `opIndex` (the nearest earlier snapshot in fast mode)
+const char* get_state_json(int handle, int opIndex) {
+    auto it = pagedResults().find(handle);
+    if (it == pagedResults().end()) {
+        return toCString("{\"error\":\"Unknown result handle\"}");
+    }
+    const Step* frame = frameAt(it->second, opIndex);
+    return toCString(frame ? serializeStep(*frame) : "null");
+}
+
+// Stats through trace op `opIndex`; "index" is the op they are exact at
+const char* get_stats_json(int handle, int opIndex) {
+    auto it = pagedResults().find(handle);
+    if (it == pagedResults().end()) {
+        return toCString("{\"error\":\"Unknown result handle\"}");
+    }
+    const Step* frame = frameAt(it->second, opIndex);
+    std::string index = "\"index\":" + std::to_string(frame ? frame->index : -1) + ",";
+    return toCString(withFields(serializeStats(frame ? frame->totals : Stats{}), index));
+}
+
+void close_result(int handle) {
+    pagedResults().erase(handle);
+}
+
 // // Emscripten bindings for easier debugging
 // EMSCRIPTEN_BINDINGS(cachesim_module) {
 //     emscripten::function("runSimulation", &run_simulation_json);
@@ -262,8 +262,8 @@ class CacheSimulator {
                             <div class="cache-value">${item.value}</div>
                         `;
                         
-                        // Add frequency badge for LFU
-                        if (result.policy === 'LFU' && currentStep.meta && currentStep.meta.freq) {
+                        // Add frequency badge for LFU (W-TinyLFU shows its sketch estimate)
+                        if ((result.policy === 'LFU' || result.policy === 'W-TinyLFU') && currentStep.meta && currentStep.meta.freq) {
                             const freq = currentStep.meta.freq[item.key];
                             if (freq) {
                                 const badge = document.createElement('div');
@@ -350,6 +350,8 @@ class CacheSimulator {
                 <td>${result.stats.misses}</td>
                 <td>${(result.stats.hitRatio * 100).toFixed(1)}%</td>
                 <td>${result.stats.evictions}</td>
+                <td>${result.stats.expirations ?? 0}</td>
+                <td>${result.stats.hitPathWrites ?? 0}</td>
             `;
             tbody.appendChild(row);
         });
@@ -362,7 +364,11 @@ class CacheSimulator {
         const steps = result.steps || result.snapshots || [];
         const totalSteps = steps.length;
         
-        this.elements.totalStepsSpan.textContent = totalSteps;
+        // Steps thinned to fit the memory budget cover every stride-th op
+        const fidelity = this.currentResults[0].fidelity;
+        this.elements.totalStepsSpan.textContent = fidelity && fidelity.stride > fidelity.requestedStride
+            ? `${totalSteps} (every ${fidelity.stride} ops)`
+            : totalSteps;
         this.elements.currentStepSpan.textContent = this.currentStep + 1;
         
         // Update button states
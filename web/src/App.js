@@ -318,6 +318,9 @@ GET C`);
               
               <div className="step-counter">
                 Step {currentStep + 1} of {results[0]?.steps?.length || 0}
+                {results[0]?.fidelity?.stride > results[0]?.fidelity?.requestedStride && (
+                  <span title="Steps were thinned to fit the memory budget"> (every {results[0].fidelity.stride} ops)</span>
+                )}
               </div>
             </div>
           </div>
@@ -375,7 +378,7 @@ GET C`);
                             <>
                               <div className="cache-key">{item.key}</div>
                               <div className="cache-value">{item.value}</div>
-                              {result.policy === 'LFU' && currentStepData?.meta?.freq?.[item.key] && (
+                              {(result.policy === 'LFU' || result.policy === 'W-TinyLFU') && currentStepData?.meta?.freq?.[item.key] && (
                                 <div className="freq-badge">
                                   {currentStepData.meta.freq[item.key]}
                                 </div>
@@ -407,6 +410,8 @@ GET C`);
                     <th>Misses</th>
                     <th>Hit Ratio</th>
                     <th>Evictions</th>
+                    <th>Expired</th>
+                    <th>Hit Writes</th>
                   </tr>
                 </thead>
                 <tbody>
@@ -417,6 +422,8 @@ GET C`);
                       <td className="miss">{result.stats.misses}</td>
                       <td>{(result.stats.hitRatio * 100).toFixed(1)}%</td>
                       <td>{result.stats.evictions}</td>
+                      <td>{result.stats.expirations ?? 0}</td>
+                      <td>{result.stats.hitPathWrites ?? 0}</td>
                     </tr>
                   ))}
                 </tbody>